@@ -0,0 +1,57 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief 彩色图像处理功能枚举
+ */
+enum class ColorFunction {
+    NONE = -1,
+    CONVERT_GRAYSCALE = 0,
+    COLOR_SELECT = 1,
+    COLOR_CLUSTER = 2,
+    COLOR_DECONVOLUTION = 3,
+    CHANNEL_OPERATION = 4
+};
+
+/**
+ * @brief 彩色图像处理算法类
+ * 包含所有颜色功能的实现，要求3通道输入的功能对其他图像原样返回
+ */
+class ColorProcessing {
+public:
+    /**
+     * @brief 构造函数
+     */
+    ColorProcessing();
+
+    /**
+     * @brief 析构函数
+     */
+    ~ColorProcessing();
+
+    static cv::Mat convertToGrayscale(const cv::Mat& image);
+    static cv::Mat colorSelect(const cv::Mat& image, int hue_min, int hue_max, int sat_min, int sat_max, int val_min, int val_max);
+    static cv::Mat colorCluster(const cv::Mat& image, int k);
+    // channel 0=蓝色, 1=绿色, 2=红色
+    static cv::Mat colorDeconvolution(const cv::Mat& image, int channel);
+    // operation 0=add, 1=subtract, 2=multiply, 3=divide
+    static cv::Mat channelOperation(const cv::Mat& image, int operation, double value);
+
+    /**
+     * @brief K-means聚类
+     * @param image 输入图像
+     * @param k 聚类数量
+     * @return 每个像素替换为所属聚类中心颜色的图像
+     */
+    static cv::Mat performKMeans(const cv::Mat& image, int k);
+
+    /**
+     * @brief 应用颜色功能
+     * @param image 输入图像
+     * @param function 颜色功能
+     * @param params 参数数组
+     * @return 处理后的图像
+     */
+    static cv::Mat applyFunction(const cv::Mat& image, ColorFunction function, const std::vector<double>& params);
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief 邻域滤波的底层实现
+ *
+ * 每像素开销与核大小无关的滑动直方图、积分图等实现，供PreProcessing等模块在核较大时选用。
+ * 多线程通过cv::parallel_for_按行条带划分；在TileProcessor等本身运行在cv::parallel_for_内的调用方中，
+ * 嵌套的并行区域由OpenCV串行执行，自动退化为单线程。
+ */
+class FilterKernels {
+public:
+    static const int kMaxMedianKernel;      // 直方图计数为16位，核大小不超过255
+
+    /**
+     * @brief 8位图像的常数时间中值滤波（Perreault-Hébert滑动直方图）
+     * 每列维护一个列直方图，核直方图分为16个粗桶和256个细桶，细桶按需同步。
+     * 边界按BORDER_REPLICATE处理，结果与cv::medianBlur逐像素相同。
+     * @param image CV_8U图像，1~4通道
+     * @param kernelSize 奇数，3~kMaxMedianKernel
+     */
+    static cv::Mat median8u(const cv::Mat& image, int kernelSize);
+
+    /**
+     * @brief 单通道图像的局部均值和方差（kernelSize×kernelSize窗口，BORDER_REFLECT_101）
+     * 每列维护窗口内的和与平方和，再沿行滑动，每像素开销与核大小无关
+     * @param image 单通道CV_8U、CV_8S、CV_16U、CV_16S、CV_32S、CV_32F或CV_64F图像
+     * @param kernelSize 正奇数
+     * @param mean 输出，CV_32F
+     * @param variance 输出，CV_32F，非负
+     */
+    static void localMoments(const cv::Mat& image, int kernelSize, cv::Mat& mean, cv::Mat& variance);
+
+    /**
+     * @brief 局部标准差，与localMoments使用同一遍滑动求和，结果直接写入输出，不产生中间图像
+     * 多通道图像逐通道处理。
+     * @param kernelSize 正奇数
+     * @param ddepth 输出位深，CV_8U（饱和截断）或CV_32F
+     * @param scale 写入前乘以的系数，用于把标准差归一化到输出范围
+     */
+    static cv::Mat localStdDev(const cv::Mat& image, int kernelSize, int ddepth = CV_32F, double scale = 1.0);
+
+    /**
+     * @brief 窗口和（kernelSize×kernelSize，BORDER_REFLECT_101），每像素开销与核大小无关
+     * 列和沿行滑动；整数输入用64位整数累加，结果精确，写出时才乘以scale并截断到输出类型。
+     * 多通道图像逐通道处理。
+     * @param kernelSize 正奇数
+     * @param ddepth 输出位深（整数类型饱和截断），-1表示与输入相同
+     * @param scale 写入前乘以的系数
+     */
+    static cv::Mat boxSum(const cv::Mat& image, int kernelSize, int ddepth = CV_32F, double scale = 1.0);
+
+    /**
+     * @brief 自适应Wiener滤波（同MATLAB wiener2）
+     * 输出 = μ + max(σ²-ν², 0) / max(σ², ν²) · (I - μ)，μ、σ²为局部均值和方差，ν²为噪声方差。
+     * 多通道图像逐通道处理，输出与输入类型相同。
+     * @param kernelSize 正奇数
+     * @param noiseVariance 噪声方差；不大于0时取全图局部方差的平均值
+     */
+    static cv::Mat wiener(const cv::Mat& image, int kernelSize, double noiseVariance = 0.0);
+
+    /**
+     * @brief 8位图像的局部香农熵（256个灰度桶，BORDER_REFLECT_101）
+     * 每行滑动一个窗口直方图，每步只加入和去掉一列，用c·log₂c查找表增量更新熵，
+     * 每像素开销与核高度成正比。多通道图像逐通道处理。
+     * @param kernelSize 正奇数
+     * @return CV_32F，单位为比特，范围0~log₂(min(kernelSize², 256))
+     */
+    static cv::Mat entropy8u(const cv::Mat& image, int kernelSize);
+
+    /**
+     * @brief 递归（IIR）高斯滤波，每像素开销与σ无关（Deriche四阶近似）
+     * 列方向的递推各列同时推进，水平方向转置后复用同一实现；两端按BORDER_REFLECT_101延拓4σ。
+     * 与未截断的FIR高斯相比，最大误差不超过输入范围的2e-4（8位图像约0.05灰度级）。
+     * 内部以CV_32F存储、double递推，输出与输入类型相同。
+     * @param sigmaX 水平方向σ，大于0
+     * @param sigmaY 垂直方向σ，大于0
+     */
+    static cv::Mat recursiveGaussian(const cv::Mat& image, double sigmaX, double sigmaY);
+};
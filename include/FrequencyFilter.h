@@ -0,0 +1,80 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief 频域掩模类型
+ */
+enum class FrequencyMaskType {
+    LOW_PASS = 0,
+    HIGH_PASS = 1,
+    BAND_PASS = 2,
+    NOTCH = 3
+};
+
+/**
+ * @brief 频域掩模参数
+ *
+ * 频率以奈奎斯特频率为单位（1 = 每像素0.5周期）。各掩模均为高斯形状，避免理想截止的振铃。
+ * 空间域σ像素的高斯模糊对应截止频率约 1/(π·σ)。
+ */
+struct FrequencyMask {
+    FrequencyMaskType type;
+    double cutoff;          // 低通/高通的截止频率；带通的下限；陷波的半径
+    double upperCutoff;     // 带通的上限
+    double notchX;          // 陷波中心（另一个自动取关于原点对称的位置）
+    double notchY;
+
+    FrequencyMask() : type(FrequencyMaskType::LOW_PASS), cutoff(0.16), upperCutoff(0.5), notchX(0.5), notchY(0.0) {}
+};
+
+/**
+ * @brief 频域滤波，缓存最近几张图像的正向频谱
+ *
+ * 图像先补边到cv::getOptimalDFTSize的尺寸，各通道的频谱按需计算并缓存；源图像的缓冲区变化后缓存失效。
+ * 同一张图像只改变掩模时，每次只需一次逐元素乘法和一次逆变换。
+ * 缓存按最近使用保留kMaxCachedImages张图像，渐进式预览的粗、细两级代理图像各占一项，不会互相挤出。
+ * 掩模可分离，按行列两个一维表在乘法时逐元素合成，不生成整幅掩模。线程安全。
+ * 缓存持有源图像和各通道的频谱，由调用方持有对象并决定生命周期（如一次预览会话），
+ * 不再需要时调用clear()释放；一次性的处理使用局部对象即可。
+ */
+class FrequencyFilter {
+private:
+    struct Entry {
+        cv::Mat source;                 // 持有源图像，保证缓冲区地址不会被复用
+        std::vector<cv::Mat> spectra;   // 各通道的频谱，CV_32FC2，补边后的尺寸
+    };
+
+    static const size_t kMaxCachedImages;
+
+    std::mutex mutex;
+    std::list<Entry> entries;       // 最近使用的在前
+    uint64_t generation;            // 每次clear()时递增，计算期间被清空的结果不再写回缓存
+
+    std::vector<cv::Mat> spectraFor(const cv::Mat& image);
+
+public:
+    FrequencyFilter();
+
+    /**
+     * @brief 应用频域掩模
+     * 高通和带通保留直流分量，输出的平均亮度与输入相同。
+     * @param image 任意位深，1~4通道
+     * @return 与输入类型相同（整数类型饱和截断）
+     */
+    cv::Mat apply(const cv::Mat& image, const FrequencyMask& mask);
+
+    /**
+     * @brief 释放缓存的全部源图像和频谱
+     */
+    void clear();
+
+    /**
+     * @brief 掩模在给定频率处的取值，频率以奈奎斯特频率为单位
+     */
+    static double response(const FrequencyMask& mask, double fx, double fy);
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include "Pipeline.h"
+
+/**
+ * @brief 撤销/重做历史中的一个状态
+ * image与处理器、流水线缓存共享像素缓冲区（引用计数），不做clone；
+ * 超出内存预算时image被释放，只保留PNG压缩数据
+ */
+struct HistoryEntry {
+    cv::Mat image;                      // 该状态的图像
+    std::vector<uchar> compressed;      // 压缩后的图像，image为空时有效
+    cv::Mat source;                     // 流水线的输入图像
+    std::vector<PipelineStep> steps;    // 该状态对应的流水线步骤
+    std::string label;                  // 操作描述
+};
+
+/**
+ * @brief 带内存预算的图像撤销/重做历史
+ *
+ * 相邻状态之间未改变的图像共享同一缓冲区，内存占用按不同缓冲区计算。
+ * 超出预算时先压缩最旧的状态，仍然超出则丢弃最旧的状态；当前状态始终保留。
+ */
+class ImageHistory {
+private:
+    std::vector<HistoryEntry> entries;
+    int currentIndex;
+    size_t memoryBudget;
+    size_t maxEntries;
+
+public:
+    /**
+     * @brief 构造函数
+     * @param memoryBudget 内存预算（字节）
+     * @param maxEntries 最多保留的状态数
+     */
+    ImageHistory(size_t memoryBudget = (size_t)512 * 1024 * 1024, size_t maxEntries = 50);
+
+    /**
+     * @brief 析构函数
+     */
+    ~ImageHistory();
+
+    /**
+     * @brief 清空历史并以给定状态作为起点
+     */
+    void reset(const cv::Mat& image, const cv::Mat& source, const std::vector<PipelineStep>& steps, const std::string& label);
+
+    /**
+     * @brief 记录新状态，丢弃当前状态之后的重做分支
+     */
+    void push(const cv::Mat& image, const cv::Mat& source, const std::vector<PipelineStep>& steps, const std::string& label);
+
+    bool canUndo() const;
+    bool canRedo() const;
+
+    /**
+     * @brief 撤销/重做，成功后通过current()获取新的当前状态
+     */
+    bool undo();
+    bool redo();
+
+    /**
+     * @brief 获取当前状态，必要时解压图像
+     */
+    const HistoryEntry& current();
+
+    /**
+     * @brief 获取撤销/重做将要恢复的状态描述
+     */
+    std::string undoLabel() const;
+    std::string redoLabel() const;
+
+    bool empty() const;
+    void clear();
+
+    /**
+     * @brief 设置内存预算（字节）
+     */
+    void setMemoryBudget(size_t bytes);
+
+    /**
+     * @brief 当前占用的内存（共享的缓冲区只计算一次）
+     */
+    size_t memoryUsage() const;
+
+private:
+    void enforceBudget();
+    static bool compressEntry(HistoryEntry& entry);
+    static void decompressEntry(HistoryEntry& entry);
+};
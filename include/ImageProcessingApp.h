@@ -2,12 +2,21 @@
 
 #include "ImageProcessor.h"
 #include "PreProcessing.h"
+#include "FrequencyFilter.h"
 #include "Segmentation.h"
 #include "Morphology.h"
 #include "CleanUp.h"
 #include "Measurements.h"
+#include "Pipeline.h"
+#include "IncrementalPipeline.h"
+#include "ImageHistory.h"
+#include "PreviewWorker.h"
+#include "ProxyPyramid.h"
+#include "ParameterSweep.h"
+#include "ParameterTracker.h"
 #include "UIComponents.h"
 #include <opencv2/opencv.hpp>
+#include <functional>
 #include <string>
 #include "cvui.h"
 
@@ -66,7 +75,8 @@ private:
         SEGMENTATION = 8,
         MORPHOLOGY = 9,
         CLEAN_UP = 10,
-        MEASUREMENTS = 11
+        MEASUREMENTS = 11,
+        RECIPE = 12
     };
 
 
@@ -75,6 +85,11 @@ private:
 
     ModalFunction currentModal;     // 当前显示的模态窗口
     cv::Mat previewImage;          // 预览图像
+    ScaledImageCache imageDisplayCache;    // 主显示区的缩放位图，按图像版本失效
+    ScaledImageCache previewDisplayCache;  // 预览区的缩放位图
+    ImageViewport viewport;                // 主显示区与预览区共用的缩放/平移状态
+    cv::Rect previewRegion;                // previewImage覆盖的源图像区域，为空表示整幅图像
+    cv::Rect submittedPreviewView;         // 最近提交的预览所对应的可见区域，未放大时为空
     bool isProcessing;             // 是否正在处理中
 
     // 模态窗口布局
@@ -99,6 +114,37 @@ private:
     MeasurementsFunction currentMeasurementsFunction;
     MeasurementResult lastMeasurementResult;
 
+    // 流水线记录：每次Apply记录为一个步骤，可保存后重放或交给批处理程序
+    // 每一步的结果都被缓存，修改某一步只重新计算该步及其下游
+    IncrementalPipeline recipe;
+    std::string recipeStatus;
+    int editingStepIndex;          // 正在编辑的步骤索引，-1表示非编辑模式
+
+    // 撤销/重做历史，快照与当前图像共享缓冲区
+    ImageHistory history;
+
+    // 预览用的低分辨率代理图像，需在previewWorker之前声明（后台任务引用它）
+    ProxyPyramid previewProxy;
+
+    // FFT预览的频谱缓存，属于一次模态窗口会话，关闭或应用后清空；同样需在previewWorker之前声明
+    FrequencyFilter fftPreviewCache;
+
+    // 后台预览线程，只计算最新的参数
+    PreviewWorker previewWorker;
+
+    // 渐进式预览：参数变化时先在1/4分辨率上计算，停止拖动后逐级细化到显示分辨率
+    typedef std::function<PreviewResult(const cv::Mat&, double)> PreviewCompute;
+    PreviewCompute previewCompute;
+    int previewRefineLevel;        // 已提交的最粗级别，0表示显示分辨率
+
+    // 参数变化检测：所有模态窗口的参数每帧与上次提交的比较，按函数耗时合并连续变化
+    ParameterTracker previewTracker;
+
+    // 参数扫描：预览区显示缩略图网格，点击一格采用该参数值
+    bool sweepActive;
+    SweepRange sweepRange;
+    std::vector<double> sweepValues;
+
     // 预处理参数
     double brightness;             // 亮度调整 (-100 to +100)
     double contrast;              // 对比度调整 (0.1 to 3.0)
@@ -114,6 +160,12 @@ private:
     double clipLimit;             // CLAHE剪切限制 (1.0 to 40.0)
     int flattenKernelSize;        // 背景平坦化核大小 (5 to 51, odd only)
 
+    // CORRECTION类别特定参数
+    int fftMaskType;              // FFT掩模类型 (0=low, 1=high, 2=band, 3=notch)
+    double fftCutoff;             // 截止频率/带通下限/陷波半径 (奈奎斯特频率的倍数)
+    double fftUpperCutoff;        // 带通上限
+    double fftNotchX, fftNotchY;  // 陷波中心
+
     // 阈值标记参数
     double thresholdValue;        // 基本阈值 (0-255)
     double thresholdMin, thresholdMax;  // 范围阈值 (0-255)
@@ -141,11 +193,6 @@ private:
     int maxObjectSize;            // 最大对象大小 (100-50000)
     double sensitivity;           // 检测敏感度 (0.1-1.0)
 
-    // 参数变化检测用的前一个值
-    double prevBrightness;
-    double prevContrast;
-    double prevClipLimit;
-    int prevFlattenKernelSize;
     
 public:
     ImageProcessingApp();
@@ -158,6 +205,7 @@ public:
     
     /**
      * @brief 运行主循环
+     * 只在有鼠标/键盘输入或后台预览完成时重绘，空闲时逐步延长轮询间隔
      */
     void run();
     
@@ -201,6 +249,7 @@ private:
     void renderMorphologyModal();
     void renderCleanUpModal();
     void renderMeasurementsModal();
+    void renderRecipeModal();
     void renderSegmentationModal();
     void renderSegmentationParameters();
     void renderBasicThresholdParameters(int startY);
@@ -213,6 +262,7 @@ private:
      * @brief 模态窗口辅助方法
      */
     void updatePreview();
+    cv::Mat previewSourceImage();
     void renderPreviewArea(int x, int y, int width, int height);
 
     /**
@@ -244,19 +294,19 @@ private:
     
     /**
      * @brief 打开文件对话框
+     * @param filter 文件类型过滤器，为空时使用图像文件过滤器
      * @return 选择的文件路径
      */
-    std::string openFileDialog();
-    
+    std::string openFileDialog(const char* filter = nullptr);
+
     /**
-     * @brief 缩放图像以适应显示区域
-     * @param image 原始图像
-     * @param maxWidth 最大宽度
-     * @param maxHeight 最大高度
-     * @return 缩放后的图像
+     * @brief 保存文件对话框
+     * @param filter 文件类型过滤器
+     * @param defaultExtension 默认扩展名
+     * @return 选择的文件路径
      */
-    cv::Mat scaleImageToFit(const cv::Mat& image, int maxWidth = 800, int maxHeight = 400);
-
+    std::string saveFileDialog(const char* filter, const char* defaultExtension);
+    
     /**
      * @brief 打开模态窗口
      */
@@ -277,6 +327,50 @@ private:
      */
     void applyCurrentFunction();
 
+    /**
+     * @brief 记录已应用的步骤到流水线
+     */
+    void recordStep(PipelineModule module, int function, const std::vector<double>& params);
+
+    /**
+     * @brief 根据当前模态窗口和参数构造流水线步骤
+     */
+    PipelineStep buildCurrentStep() const;
+
+    /**
+     * @brief 当前模态窗口预览更新的计时项名称
+     * @param level 渐进预览的级别，大于0时加上 " 1/2^level" 后缀
+     */
+    std::string previewTimerName(int level = 0) const;
+
+    /**
+     * @brief 在模态窗口中显示预览与当前功能的最近一次/p95耗时
+     */
+    void renderTimingInfo(int x, int y);
+
+    /**
+     * @brief 打开步骤对应的模态窗口并恢复其参数
+     * @return 该步骤是否可编辑
+     */
+    bool loadStepParameters(const PipelineStep& step);
+
+    /**
+     * @brief 用当前参数替换正在编辑的步骤，并通过缓存重新执行流水线
+     */
+    void applyEditedStep();
+
+    /**
+     * @brief 将当前图像和流水线记录为新的历史状态
+     */
+    void recordHistory(const std::string& label);
+
+    /**
+     * @brief 撤销/重做，恢复历史中的图像和流水线步骤
+     */
+    void undo();
+    void redo();
+    void restoreHistoryState();
+
     /**
      * @brief 应用预处理功能
      */
@@ -346,4 +440,80 @@ private:
      * @brief 更新测量预览
      */
     void updateMeasurementsPreview(MeasurementsFunction function);
+
+    /**
+     * @brief 将预览计算提交到后台线程
+     * 计算在与预览区域分辨率相当的代理图像上进行，先提交粗分辨率的结果，
+     * 之后由refinePreview逐级细化
+     * @param compute 以代理图像和其缩放比例为参数的计算，参数必须按值捕获，
+     *                与尺寸相关的参数用ProxyPyramid::scaleStep换算
+     */
+    void submitPreview(PreviewCompute compute);
+
+    /**
+     * @brief 提交某一细化级别的预览计算
+     * @param level 相对显示分辨率缩小2^level倍
+     */
+    void submitPreviewLevel(int level);
+
+    /**
+     * @brief 将当前参数交给previewTracker，需要时重新计算预览
+     * 廉价的函数每次变化都立即计算，耗时的函数在拖动时按实测耗时限速
+     * @return 是否提交了新的计算
+     */
+    bool trackPreviewParameters();
+
+    /**
+     * @brief 后台空闲且没有拖动控件时，提交下一更细级别的预览
+     * @return 是否提交了新的计算
+     */
+    bool refinePreview();
+
+    /**
+     * @brief 比level更细、且实际分辨率不同的下一级别
+     */
+    int nextPreviewLevel(int level);
+
+    /**
+     * @brief 当前功能有可扫描的参数时渲染Sweep按钮
+     */
+    void renderSweepButton(int x, int y);
+
+    /**
+     * @brief 在后台并行计算当前功能主要参数的缩略图网格，显示在预览区
+     */
+    void startParameterSweep();
+
+    /**
+     * @brief 采用网格中被点击的参数值并恢复普通预览
+     */
+    void applySweepValue(double value);
+
+    /**
+     * @brief 放大查看时可见区域变化后重新提交预览
+     * @return 是否提交了新的计算
+     */
+    bool updatePreviewViewport();
+
+    /**
+     * @brief 主显示区和预览区中图像可用的显示尺寸
+     */
+    cv::Size mainViewSize() const;
+    cv::Size previewViewSize() const;
+
+    /**
+     * @brief 渲染模态窗口中的预览区域、缩放按钮，并处理拖动平移
+     */
+    void renderPreview();
+
+    /**
+     * @brief 当前可见区域在previewImage中的像素范围，未放大时为空
+     */
+    cv::Rect previewDisplayRegion();
+
+    /**
+     * @brief 每次循环取回后台完成的预览
+     * @return 取回了新的预览时返回true，需要重绘
+     */
+    bool collectPreviewResult();
 };
\ No newline at end of file
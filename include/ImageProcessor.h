@@ -1,10 +1,15 @@
 #pragma once
 
 #include <opencv2/opencv.hpp>
+#include <cstdint>
 #include <string>
 
 /**
  * @brief 图像处理应用程序的核心类
+ *
+ * 缓冲区所有权规则：originalImage、currentImage、displayImage与流水线缓存、撤销历史、
+ * 预览之间通过cv::Mat引用计数共享像素缓冲区，不做clone。任何处理都必须写入新的输出
+ * 图像，不得原地修改传入或取得的图像；需要原地修改时先显式clone。
  */
 class ImageProcessor {
 private:
@@ -12,6 +17,8 @@ private:
     cv::Mat currentImage;      // 当前处理后的图像
     cv::Mat displayImage;      // 用于显示的图像
     std::string imagePath;     // 图像文件路径
+    cv::Size fullSize;         // 文件中原始分辨率的尺寸，超大的金字塔TIFF只加载较小的层级
+    uint64_t imageVersion;     // 每次当前图像变化时递增
 
 public:
     /**
@@ -31,6 +38,18 @@ public:
      */
     bool loadImage(const std::string& imagePath);
 
+    /**
+     * @brief 文件中原始分辨率的尺寸
+     * 超大的金字塔TIFF只把适合交互的层级解码为原始图像，此时大于getImageSize()；
+     * 所有处理和记录的流水线参数都基于加载的层级
+     */
+    cv::Size getFullSize() const;
+
+    /**
+     * @brief 加载的层级相对原始分辨率的比例，1表示原始分辨率
+     */
+    double getLoadScale() const;
+
     /**
      * @brief 重置到原始图像
      */
@@ -48,6 +67,12 @@ public:
      */
     const cv::Mat& getDisplayImage() const;
 
+    /**
+     * @brief 当前图像的版本号，图像每次变化（包括加载和重置）时递增
+     * 界面据此判断缓存的缩放结果是否仍然有效
+     */
+    uint64_t getImageVersion() const;
+
     /**
      * @brief 转换为灰度图像
      */
@@ -87,8 +112,15 @@ public:
     bool hasImage() const;
     cv::Size getImageSize() const;
     void updateDisplayImage();
+
+    /**
+     * @brief 替换当前图像，与传入图像共享像素缓冲区而不做clone
+     * 右值版本直接接管传入图像的引用，避免引用计数的增减
+     */
     void setCurrentImage(const cv::Mat& image);
+    void setCurrentImage(cv::Mat&& image);
     void applyPreProcessedImage(const cv::Mat& processedImage);
+    void applyPreProcessedImage(cv::Mat&& processedImage);
 
     // 公共算法方法
     cv::Mat performKMeans(const cv::Mat& image, int k);
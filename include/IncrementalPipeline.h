@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Pipeline.h"
+#include <cstdint>
+#include <map>
+
+/**
+ * @brief 带逐级结果缓存的增量流水线
+ *
+ * 每个步骤的输出以 (上游结果id, 模块, 功能, 参数) 为键缓存。修改某一步的参数只会
+ * 使该步及其下游的键发生变化，上游步骤直接命中缓存；改回之前用过的参数同样命中缓存。
+ * 缓存的图像与调用方共享像素缓冲区（不做clone），调用方不得原地修改这些图像。
+ */
+class IncrementalPipeline {
+private:
+    struct StageKey {
+        uint64_t inputId;
+        int module;
+        int function;
+        std::vector<double> params;
+
+        bool operator<(const StageKey& other) const;
+    };
+
+    struct StageResult {
+        cv::Mat image;
+        MeasurementResult measurement;
+        uint64_t resultId;
+        uint64_t lastUsed;
+    };
+
+    cv::Mat source;                         // 流水线输入图像
+    uint64_t sourceId;                      // 输入图像的结果id
+    std::vector<PipelineStep> steps;
+    std::map<StageKey, StageResult> cache;
+    uint64_t nextId;
+    uint64_t useClock;
+    size_t cacheBudgetBytes;                // 缓存内存预算
+    int lastExecutedStages;                 // 最近一次执行中实际重新计算的步骤数
+
+public:
+    /**
+     * @brief 构造函数
+     */
+    IncrementalPipeline();
+
+    /**
+     * @brief 析构函数
+     */
+    ~IncrementalPipeline();
+
+    /**
+     * @brief 设置输入图像并清空步骤
+     * 与当前输入共享同一缓冲区时保留缓存，否则清空缓存
+     */
+    void setSource(const cv::Mat& image);
+    const cv::Mat& getSource() const;
+
+    /**
+     * @brief 清空步骤，保留输入图像和缓存
+     */
+    void clearSteps();
+
+    /**
+     * @brief 追加步骤
+     */
+    void appendStep(const PipelineStep& step);
+
+    /**
+     * @brief 追加已经计算过的步骤，直接以其结果填充缓存
+     * @param step 处理步骤
+     * @param result 该步骤在当前末端图像上的输出
+     * @param measurement 测量步骤的结果
+     */
+    void appendStep(const PipelineStep& step, const cv::Mat& result, const MeasurementResult& measurement);
+
+    /**
+     * @brief 整体替换步骤列表（用于撤销/重做），缓存中已有的结果继续有效
+     */
+    void setSteps(const std::vector<PipelineStep>& newSteps);
+
+    void replaceStep(size_t index, const PipelineStep& step);
+    void removeStep(size_t index);
+    const std::vector<PipelineStep>& getSteps() const;
+
+    /**
+     * @brief 执行流水线，仅重新计算缓存未命中的步骤
+     * @param lastMeasurement 可选，最后一个测量步骤的结果
+     * @return 最后一步的输出
+     */
+    cv::Mat run(MeasurementResult* lastMeasurement = nullptr);
+
+    /**
+     * @brief 获取第index个步骤的输入图像（即前index个步骤的输出）
+     */
+    cv::Mat stageInput(size_t index);
+
+    /**
+     * @brief 设置缓存内存预算（字节），超出时淘汰最久未使用且不在当前链上的结果
+     */
+    void setCacheBudget(size_t bytes);
+
+    int getLastExecutedStages() const;
+    size_t getCachedBytes() const;
+
+private:
+    cv::Mat evaluate(size_t count, MeasurementResult* lastMeasurement, uint64_t* resultId);
+    void enforceBudget();
+    static StageKey makeKey(uint64_t inputId, const PipelineStep& step);
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 日志级别
+ */
+enum class LogLevel {
+    TRACE = 0,   // 逐元素的细节（每个轮廓、每个特征）
+    DEBUG = 1,
+    INFO = 2,
+    WARN = 3,
+    ERR = 4,     // 不使用ERROR，避免与windows.h中的同名宏冲突
+    OFF = 5
+};
+
+/**
+ * @brief 编译期最低日志级别
+ * 低于该级别的LOG_*语句在预处理阶段被整体移除，参数表达式也不会求值。
+ * Release构建由CMake定义为2（INFO），其他构建保留全部级别
+ */
+#ifndef IP_LOG_MIN_LEVEL
+#define IP_LOG_MIN_LEVEL 0
+#endif
+
+/**
+ * @brief 环形缓冲区中的一条日志
+ */
+struct LogRecord {
+    LogLevel level;
+    int64_t timestampNs;        // steady_clock时间戳
+    std::string message;
+};
+
+/**
+ * @brief 日志系统
+ *
+ * 所有通过运行期级别检查的日志都写入固定大小的无锁环形缓冲区（多线程写入不加锁，
+ * 消息超长时截断），达到控制台级别的日志同时输出到std::cout（不使用std::endl刷新）。
+ * 控制台级别默认INFO，可通过环境变量IP_LOG_LEVEL（trace/debug/info/warn/error/off）修改。
+ */
+class Logger {
+public:
+    /**
+     * @brief 运行期检查：该级别的日志是否需要格式化
+     */
+    static bool isEnabled(LogLevel level);
+
+    /**
+     * @brief 写入一条日志
+     */
+    static void write(LogLevel level, const std::string& message);
+
+    /**
+     * @brief 设置写入环形缓冲区/控制台的最低级别
+     */
+    static void setCaptureLevel(LogLevel level);
+    static void setConsoleLevel(LogLevel level);
+    static LogLevel getConsoleLevel();
+
+    /**
+     * @brief 获取环形缓冲区中最近的日志（按时间顺序）
+     * @param maxCount 最多返回的条数
+     */
+    static std::vector<LogRecord> recent(size_t maxCount = 256);
+
+    static const char* levelName(LogLevel level);
+    static LogLevel levelFromName(const std::string& name, LogLevel defaultLevel);
+};
+
+#define IP_LOG(level, expr)                                        \
+    do {                                                           \
+        if (Logger::isEnabled(level)) {                            \
+            std::ostringstream ipLogStream;                        \
+            ipLogStream << expr;                                   \
+            Logger::write(level, ipLogStream.str());               \
+        }                                                          \
+    } while (0)
+
+#if IP_LOG_MIN_LEVEL <= 0
+#define LOG_TRACE(expr) IP_LOG(LogLevel::TRACE, expr)
+#else
+#define LOG_TRACE(expr) do {} while (0)
+#endif
+
+#if IP_LOG_MIN_LEVEL <= 1
+#define LOG_DEBUG(expr) IP_LOG(LogLevel::DEBUG, expr)
+#else
+#define LOG_DEBUG(expr) do {} while (0)
+#endif
+
+#if IP_LOG_MIN_LEVEL <= 2
+#define LOG_INFO(expr) IP_LOG(LogLevel::INFO, expr)
+#else
+#define LOG_INFO(expr) do {} while (0)
+#endif
+
+#if IP_LOG_MIN_LEVEL <= 3
+#define LOG_WARN(expr) IP_LOG(LogLevel::WARN, expr)
+#else
+#define LOG_WARN(expr) do {} while (0)
+#endif
+
+#if IP_LOG_MIN_LEVEL <= 4
+#define LOG_ERROR(expr) IP_LOG(LogLevel::ERR, expr)
+#else
+#define LOG_ERROR(expr) do {} while (0)
+#endif
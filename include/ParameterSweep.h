@@ -0,0 +1,75 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include "Pipeline.h"
+
+/**
+ * @brief 扫描的参数及其范围
+ */
+struct SweepRange {
+    int paramIndex;         // 在PipelineStep::params中的下标
+    double from;
+    double to;
+    bool oddInteger;        // 核大小、块大小等只取奇数
+    std::string label;      // 缩略图上显示的参数名
+
+    SweepRange() : paramIndex(-1), from(0), to(0), oddInteger(false) {}
+};
+
+/**
+ * @brief 扫描中的一格
+ */
+struct SweepCell {
+    double value;
+    cv::Mat thumbnail;      // CV_8UC3，不超过格子尺寸
+};
+
+/**
+ * @brief 参数扫描：对同一输入以一组参数值分别执行一个步骤，生成缩略图网格
+ *
+ * 各参数值在线程池中并行计算。输入只缩小一次，需要灰度输入的步骤（分割、特征分离）也只转换一次灰度，
+ * 各格共享这些中间结果，因此整个网格的开销与一次预览相当。
+ */
+class ParameterSweep {
+public:
+    /**
+     * @brief 步骤的默认扫描参数
+     * @return 该步骤没有适合扫描的参数时返回false
+     */
+    static bool defaultRange(const PipelineStep& step, SweepRange& range);
+
+    /**
+     * @brief 在范围内均匀取count个值；奇数参数取奇数并去重
+     */
+    static std::vector<double> values(const SweepRange& range, int count);
+
+    /**
+     * @brief 并行计算所有参数值的缩略图
+     * @param image 输入图像（已是预览分辨率）
+     * @param step 基准步骤，其中paramIndex处的参数被依次替换，该参数必须已给出
+     * @param scale 输入相对全分辨率图像的比例，用于换算与尺寸相关的参数
+     * @param cellSize 缩略图的最大尺寸
+     * 各格在OpenCV线程池上并行，并行度由线程池决定，不修改全局线程设置
+     */
+    static std::vector<SweepCell> run(const cv::Mat& image, const PipelineStep& step, int paramIndex,
+                                      const std::vector<double>& values, double scale, const cv::Size& cellSize);
+
+    /**
+     * @brief 网格中第index格的位置
+     * @param count 格子总数
+     * @param gridSize 整个网格的尺寸
+     */
+    static cv::Rect cellRect(int index, int count, const cv::Size& gridSize);
+
+    /**
+     * @brief 将缩略图拼成网格，每格标注参数值
+     */
+    static cv::Mat composeGrid(const std::vector<SweepCell>& cells, const SweepRange& range, const cv::Size& gridSize);
+
+    /**
+     * @brief 参数值的显示文本，例如 "k=7"
+     */
+    static std::string cellLabel(const SweepRange& range, double value);
+};
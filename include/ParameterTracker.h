@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <string>
+#include "Pipeline.h"
+
+/**
+ * @brief 预览参数的变化检测与限速
+ *
+ * 界面每帧把当前参数交给observe()，由它决定是否现在重新计算预览。连续的变化（拖动滑块）
+ * 合并为一次：一次预览的耗时不超过instantMs的函数每次变化都立即计算；更慢的函数两次计算之间
+ * 至少间隔其实测耗时（不超过maxIntervalMs），间隔内的中间值被跳过，最后一个值总会被计算。
+ * 切换函数和requestUpdate()不受间隔限制。
+ */
+class ParameterTracker {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    static const double kDefaultInstantMs;
+    static const double kDefaultMaxIntervalMs;
+
+    ParameterTracker();
+
+    /**
+     * @brief 设置限速策略
+     * @param instantMs 预览耗时不超过此值的函数不限速
+     * @param maxIntervalMs 两次计算的最大间隔
+     */
+    void setPolicy(double instantMs, double maxIntervalMs);
+
+    /**
+     * @brief 为某个函数指定固定的最小间隔，覆盖按耗时计算的间隔
+     * @param timerName Pipeline::timerName()的结果
+     * @param intervalMs 最小间隔，0表示不限速
+     */
+    void setInterval(const std::string& timerName, double intervalMs);
+
+    /**
+     * @brief 检查当前参数
+     * @param step 当前参数，module为NONE表示没有可预览的函数
+     * @param costMs 该函数一次预览的实测耗时，未知时为0
+     * @param now 当前时间
+     * @return 现在应当重新计算预览时返回true，调用者必须随即提交
+     */
+    bool observe(const PipelineStep& step, double costMs, Clock::time_point now);
+
+    /**
+     * @brief 下一次observe()无条件返回true（"Update Preview"按钮等）
+     */
+    void requestUpdate();
+
+    /**
+     * @brief 是否有被限速推迟的变化，此时主循环不应进入空闲
+     */
+    bool hasPending() const;
+
+    /**
+     * @brief 忘记已提交的参数，下一次observe()视为新函数
+     */
+    void reset();
+
+    /**
+     * @brief 按策略计算某个函数的最小间隔（毫秒）
+     */
+    double intervalFor(const PipelineStep& step, double costMs) const;
+
+private:
+    static bool sameFunction(const PipelineStep& a, const PipelineStep& b);
+
+    double instantMs;
+    double maxIntervalMs;
+    std::map<std::string, double> intervals;
+
+    bool hasSubmitted;
+    PipelineStep submitted;          // 最近一次提交的参数
+    Clock::time_point submittedAt;
+    bool pending;                    // 参数与submitted不同但尚未提交
+    bool forced;
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include "PreProcessing.h"
+#include "Segmentation.h"
+#include "Morphology.h"
+#include "CleanUp.h"
+#include "Measurements.h"
+#include "ColorProcessing.h"
+
+/**
+ * @brief 流水线步骤所属的模块
+ */
+enum class PipelineModule {
+    NONE = -1,
+    PRE_PROCESSING = 0,
+    SEGMENTATION = 1,
+    MORPHOLOGY = 2,
+    CLEAN_UP = 3,
+    MEASUREMENTS = 4,
+    COLOR = 5
+};
+
+/**
+ * @brief 流水线中的单个处理步骤
+ * function为对应模块功能枚举的整数值，params原样传给该模块的applyFunction
+ */
+struct PipelineStep {
+    PipelineModule module;
+    int function;
+    std::vector<double> params;
+
+    PipelineStep() : module(PipelineModule::NONE), function(-1) {}
+    PipelineStep(PipelineModule module, int function, const std::vector<double>& params)
+        : module(module), function(function), params(params) {}
+};
+
+/**
+ * @brief 图像处理流水线
+ * 按顺序对图像执行一组步骤，不依赖任何UI组件，可用于批处理
+ *
+ * 流水线定义文件使用cv::FileStorage格式（YAML或JSON），例如:
+ *   steps:
+ *     - { module: "PreProcessing", function: 3, params: [ 5 ] }
+ *     - { module: "Segmentation", function: 0, params: [ 127, 0 ] }
+ */
+class Pipeline {
+private:
+    std::vector<PipelineStep> steps;
+
+public:
+    /**
+     * @brief 构造函数
+     */
+    Pipeline();
+
+    /**
+     * @brief 析构函数
+     */
+    ~Pipeline();
+
+    /**
+     * @brief 从文件加载流水线定义
+     * @param path 定义文件路径 (.yml/.yaml/.json)
+     * @return 是否成功加载
+     */
+    bool loadFromFile(const std::string& path);
+
+    /**
+     * @brief 保存流水线定义到文件
+     * @param path 定义文件路径 (.yml/.yaml/.json)
+     * @return 是否成功保存
+     */
+    bool saveToFile(const std::string& path) const;
+
+    void addStep(const PipelineStep& step);
+    void clear();
+    bool empty() const;
+    const std::vector<PipelineStep>& getSteps() const;
+
+    /**
+     * @brief 依次执行所有步骤
+     * @param image 输入图像
+     * @param measurements 可选，收集测量步骤的结果
+     * @return 处理后的图像
+     */
+    cv::Mat run(const cv::Mat& image, std::vector<MeasurementResult>* measurements = nullptr) const;
+
+    /**
+     * @brief 执行单个步骤
+     * 测量步骤返回与界面一致的标注图像，并通过measurement输出测量结果
+     * @param image 输入图像
+     * @param step 处理步骤
+     * @param measurement 可选，测量结果输出
+     * @return 处理后的图像
+     */
+    static cv::Mat applyStep(const cv::Mat& image, const PipelineStep& step, MeasurementResult* measurement = nullptr);
+
+    /**
+     * @brief 模块名称与枚举之间的转换
+     */
+    static const char* moduleName(PipelineModule module);
+    static PipelineModule moduleFromName(const std::string& name);
+
+    /**
+     * @brief 生成步骤的简短描述，用于界面列表和日志
+     */
+    static std::string describeStep(const PipelineStep& step);
+
+    /**
+     * @brief 步骤对应的计时项名称，例如 "PreProcessing #3"
+     * 与各模块applyFunction在Profiler中记录的名称一致
+     */
+    static std::string timerName(const PipelineStep& step);
+};
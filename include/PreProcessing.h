@@ -2,6 +2,8 @@
 
 #include <opencv2/opencv.hpp>
 
+class FrequencyFilter;
+
 /**
  * @brief 预处理功能枚举
  */
@@ -60,15 +62,21 @@ public:
     static cv::Mat flattenBackground(const cv::Mat& image, int kernelSize);
 
     // NOISE-REDUCTION类别算法
-    //kernelSize 1~31, must be odd
+    //kernelSize为奇数；8位图像最大255，大核使用常数时间的滑动直方图
     static cv::Mat medianFilter(const cv::Mat& image, int kernelSize);
-    static cv::Mat wienerFilter(const cv::Mat& image, int kernelSize);
+    //noiseVariance不大于0时由全图局部方差的平均值估计
+    static cv::Mat wienerFilter(const cv::Mat& image, int kernelSize, double noiseVariance = 0.0);
     static cv::Mat nonLocalMeans(const cv::Mat& image, double h, int templateWindowSize, int searchWindowSize);
 
     // BLUR类别算法
+    //σ不小于10且核覆盖±3σ（或kernelSize≤0）时使用开销与σ无关的递归高斯
     static cv::Mat gaussianBlur(const cv::Mat& image, int kernelSize, double sigmaX, double sigmaY);
+    //gaussianBlur是否选用递归高斯；是时通过sx、sy返回实际使用的σ（递归高斯的支撑不截断，按±4σ计算邻域）
+    static bool usesRecursiveGaussian(int kernelSize, double sigmaX, double sigmaY, double& sx, double& sy);
     static cv::Mat averageBlur(const cv::Mat& image, int kernelSize);
-    static cv::Mat sumFilter(const cv::Mat& image, int kernelSize);
+    //窗口和乘以scale，ddepth为输出位深（整数类型饱和截断），-1表示与输入相同；
+    //applyFunction的params为{kernelSize, 0=float/1=int32/-1=与输入相同, scale}，只给出kernelSize的旧配方保持输入位深
+    static cv::Mat sumFilter(const cv::Mat& image, int kernelSize, int ddepth = CV_32F, double scale = 1.0);
     static cv::Mat grayscaleDilate(const cv::Mat& image, int kernelSize);
     static cv::Mat grayscaleErode(const cv::Mat& image, int kernelSize);
 
@@ -86,7 +94,10 @@ public:
 
     // CORRECTION类别算法
     static cv::Mat sharpen(const cv::Mat& image, double strength);
-    static cv::Mat fftFilter(const cv::Mat& image);
+    //maskType: 0=低通 1=高通 2=带通 3=陷波（FrequencyMaskType）；频率以奈奎斯特频率为单位
+    //默认的低通0.16约相当于σ=2的高斯模糊；给出cache时同一图像的正向频谱被缓存，只改参数时不重做正向变换
+    static cv::Mat fftFilter(const cv::Mat& image, int maskType = 0, double cutoff = 0.16, double upperCutoff = 0.5,
+                             double notchX = 0.5, double notchY = 0.0, FrequencyFilter* cache = nullptr);
     static cv::Mat grayscaleInterpolation(const cv::Mat& image);
     static cv::Mat grayscaleReconstruction(const cv::Mat& image);
 
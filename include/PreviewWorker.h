@@ -0,0 +1,84 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "Measurements.h"
+
+/**
+ * @brief 后台预览计算的结果
+ */
+struct PreviewResult {
+    cv::Mat image;
+    bool hasMeasurement;
+    MeasurementResult measurement;      // 测量预览的统计结果
+    cv::Rect region;                    // image覆盖的源图像区域（全分辨率坐标），为空表示整幅图像
+
+    PreviewResult() : hasMeasurement(false) {}
+};
+
+/**
+ * @brief 后台预览线程，只计算最新提交的参数
+ *
+ * submit()替换尚未开始的任务（只保留最新的一个）。正在运行的OpenCV调用无法中断，
+ * 它的结果在有更新的任务提交后会被丢弃。完成的结果在互斥锁保护下整体交给界面线程，
+ * 界面线程通过takeResult()在每帧开始时取走，因此预览图像只在界面线程中被修改。
+ * 任务中使用的图像必须按值捕获（共享缓冲区，不做clone），且不得原地修改。
+ */
+class PreviewWorker {
+public:
+    typedef std::function<PreviewResult()> Job;
+
+    /**
+     * @brief 构造函数，启动后台线程
+     */
+    PreviewWorker();
+
+    /**
+     * @brief 析构函数，等待当前任务结束后停止线程
+     */
+    ~PreviewWorker();
+
+    /**
+     * @brief 提交预览任务，替换尚未开始的旧任务
+     */
+    void submit(Job job);
+
+    /**
+     * @brief 丢弃尚未开始的任务，并让正在运行的任务的结果失效
+     */
+    void cancel();
+
+    /**
+     * @brief 取走最新完成的结果
+     * @return 自上次调用以来有新结果时返回true
+     */
+    bool takeResult(PreviewResult& result);
+
+    /**
+     * @brief 是否有任务排队或正在计算
+     */
+    bool isBusy() const;
+
+    PreviewWorker(const PreviewWorker&) = delete;
+    PreviewWorker& operator=(const PreviewWorker&) = delete;
+
+private:
+    void workerLoop();
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::thread thread;
+
+    Job pendingJob;
+    uint64_t latestGeneration;      // 最近一次submit/cancel的序号
+    uint64_t pendingGeneration;
+    bool running;                   // 正在计算
+    bool stopping;
+
+    PreviewResult finishedResult;
+    bool hasFinishedResult;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 一个计时项的统计结果（毫秒）
+ */
+struct TimingStats {
+    std::string name;
+    size_t count;
+    double lastMs;
+    double meanMs;
+    double minMs;
+    double maxMs;
+    double p50Ms;
+    double p95Ms;
+
+    TimingStats() : count(0), lastMs(0), meanMs(0), minMs(0), maxMs(0), p50Ms(0), p95Ms(0) {}
+};
+
+/**
+ * @brief 对数分桶的延迟直方图
+ * 覆盖1微秒到1000秒，每十倍20个桶（相邻桶约相差12%），百分位数的误差在一个桶宽之内
+ */
+class LatencyHistogram {
+public:
+    static const int kBucketsPerDecade = 20;
+    static const int kDecades = 9;
+    static const int kBucketCount = kBucketsPerDecade * kDecades + 2;   // 含下溢/上溢桶
+    static const double kMinMs;
+
+    LatencyHistogram();
+
+    void add(double ms);
+    size_t count() const;
+
+    /**
+     * @brief 估计百分位数
+     * @param quantile 0~1
+     */
+    double percentile(double quantile) const;
+
+    /**
+     * @brief 桶的上界（毫秒）
+     */
+    static double bucketUpperMs(int bucket);
+    const std::vector<size_t>& bucketCounts() const;
+
+private:
+    std::vector<size_t> buckets;
+    size_t total;
+};
+
+/**
+ * @brief 进程内的计时统计
+ *
+ * 所有模块的applyFunction、界面的预览更新和应用操作都通过ScopedTimer记录耗时，
+ * 按名称汇总为直方图。记录和查询线程安全。
+ */
+class Profiler {
+public:
+    /**
+     * @brief 记录一次耗时
+     */
+    static void record(const std::string& name, double ms);
+
+    /**
+     * @brief 获取一个计时项的统计
+     * @return 没有记录时返回false
+     */
+    static bool getStats(const std::string& name, TimingStats& stats);
+
+    /**
+     * @brief 所有计时项的统计，按名称排序
+     */
+    static std::vector<TimingStats> allStats();
+
+    /**
+     * @brief 将统计和直方图写入CSV文件，用于离线分析
+     * 每行一个计时项；histogram列为 "桶上界ms:次数" 的分号分隔列表，只列出非空的桶
+     */
+    static bool dumpToFile(const std::string& path);
+
+    static void reset();
+};
+
+/**
+ * @brief 作用域计时器，析构时把耗时记录到Profiler
+ */
+class ScopedTimer {
+private:
+    std::string name;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedTimer(const std::string& name);
+    ~ScopedTimer();
+
+    double elapsedMs() const;
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <map>
+#include <mutex>
+#include "Pipeline.h"
+
+/**
+ * @brief 预览用的多分辨率代理图像
+ *
+ * 第n层为源图像按2^-n缩小（INTER_AREA）的结果，按需生成并缓存；源图像的缓冲区变化后缓存失效。
+ * 预览只需要显示区域的分辨率，因此在不小于显示尺寸的最小一层上计算。线程安全。
+ */
+class ProxyPyramid {
+private:
+    std::mutex mutex;
+    cv::Mat source;                 // 持有源图像，保证缓冲区地址不会被复用
+    std::map<int, cv::Mat> levels;
+
+public:
+    ProxyPyramid();
+
+    /**
+     * @brief 获取适合在displaySize区域内显示的代理图像
+     * @param image 全分辨率图像
+     * @param displaySize 预览区域尺寸，图像按比例缩放到该区域内
+     * @param scale 输出，代理图像相对全分辨率图像的比例 (0, 1]
+     * @return 代理图像，与缓存共享缓冲区，不得原地修改
+     */
+    cv::Mat proxyFor(const cv::Mat& image, const cv::Size& displaySize, double* scale);
+
+    /**
+     * @brief proxyFor对给定尺寸会选择的层级的缩放比例 (0, 1]，不生成图像
+     */
+    static double levelScale(const cv::Size& imageSize, const cv::Size& displaySize);
+
+    /**
+     * @brief 释放缓存的源图像和各层
+     */
+    void clear();
+
+    /**
+     * @brief 将步骤中与尺寸相关的参数换算到缩放后的图像上
+     * 核大小、窗口大小按scale缩放并保持为奇数，面积类参数（孔洞、特征、目标大小）按scale²缩放，频域截止频率除以scale。
+     * 缺省的参数先补为各模块applyFunction的默认值再缩放。
+     * scale大于1时反向换算，例如将在缩小的图像上记录的步骤换算回全分辨率。
+     * @param step 全分辨率下的步骤
+     * @param scale 图像缩放比例
+     * @return 换算后的步骤
+     */
+    static PipelineStep scaleStep(const PipelineStep& step, double scale);
+
+    /**
+     * @brief 将代理图像上的测量结果换算回全分辨率（面积除以scale²）
+     */
+    static MeasurementResult unscaleMeasurement(const MeasurementResult& result, double scale);
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "TileProcessor.h"
+
+/**
+ * @brief 按区域解码的TIFF图像来源
+ *
+ * 只读取文件头，不解码像素；readRegion按需解码与区域相交的TIFF分块（tile）或条带（strip），
+ * 解码结果放入按内存预算淘汰的LRU缓存。文件中尺寸递减的其他目录（IFD）作为金字塔层级。
+ * 支持8/16位、1/3/4通道、交错存储（PLANARCONFIG_CONTIG）的TIFF。输出与cv::imread的默认方式一致（8位BGR），
+ * 因此界面、批处理和分块处理对同一文件得到相同的输入。
+ * 需要libtiff（编译时定义HAVE_TIFF），否则isOpen()总是返回false。
+ */
+class TiffImageSource : public TileSource {
+private:
+    struct Level {
+        int directory;          // TIFF目录序号
+        cv::Size size;
+        bool tiled;
+        int blockWidth;         // 分块宽度；条带存储时为图像宽度
+        int blockHeight;        // 分块高度或每条带行数
+        bool jpegYCbCr;         // JPEG压缩的YCbCr数据，由libtiff转换为RGB
+    };
+
+    struct BlockKey {
+        int level;
+        int index;
+        bool operator<(const BlockKey& other) const {
+            return level != other.level ? level < other.level : index < other.index;
+        }
+    };
+
+    std::string path;
+    void* handle;               // TIFF*，读取文件头的句柄，避免在头文件中引入tiffio.h
+    int fileType;               // 文件中的像素类型
+    std::vector<Level> levels;
+
+    // libtiff的句柄不是线程安全的：每个正在解码的线程从句柄池取一个独占的句柄，
+    // 锁只保护缓存、正在解码的分块集合和句柄池，解码本身在锁外并行
+    std::mutex mutex;
+    std::condition_variable blockDecoded;
+    std::vector<void*> idleHandles;
+    std::set<BlockKey> decoding;    // 正在被某个线程解码的分块，其他线程等待而不重复解码
+    std::list<BlockKey> lruOrder;
+    std::map<BlockKey, std::pair<cv::Mat, std::list<BlockKey>::iterator>> blockCache;
+    size_t cacheBytes;
+    size_t cacheBudgetBytes;
+
+public:
+    /**
+     * @brief 打开TIFF文件
+     * @param path 文件路径
+     * @param cacheBudget 已解码分块的缓存上限（字节）
+     */
+    explicit TiffImageSource(const std::string& path, size_t cacheBudget = (size_t)256 * 1024 * 1024);
+
+    /**
+     * @brief 析构函数
+     */
+    ~TiffImageSource();
+
+    /**
+     * @brief 是否成功打开且格式受支持
+     */
+    bool isOpen() const;
+
+    cv::Size size() const override;
+    cv::Mat readRegion(const cv::Rect& region) override;
+
+    /**
+     * @brief 金字塔层级，0为原始分辨率
+     */
+    int levelCount() const;
+    cv::Size levelSize(int level) const;
+
+    /**
+     * @brief 读取指定层级中的一个矩形区域（坐标为该层级的像素坐标）
+     */
+    cv::Mat readRegion(const cv::Rect& region, int level);
+
+    /**
+     * @brief 像素数不超过maxPixels的最大层级；都超过时返回最小的层级
+     */
+    int levelForPixels(size_t maxPixels) const;
+
+    /**
+     * @brief 打开图像作为分块来源
+     * 可按区域解码的TIFF返回TiffImageSource，其他文件用cv::imread整体解码后返回MatTileSource
+     * @return 失败时返回nullptr
+     */
+    static std::shared_ptr<TileSource> openFile(const std::string& path);
+
+private:
+    bool readHeader();
+    cv::Mat fetchBlock(int level, int index);
+    void* openHandle();
+    void closeHandle(void* tif);
+    cv::Mat decodeBlock(void* tif, int level, int index);
+    void evictBlocks();
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Pipeline.h"
+
+/**
+ * @brief 分块读取的图像来源
+ * readRegion可能被多个线程同时调用，实现必须线程安全
+ */
+class TileSource {
+public:
+    virtual ~TileSource() {}
+
+    /**
+     * @brief 整幅图像的尺寸
+     */
+    virtual cv::Size size() const = 0;
+
+    /**
+     * @brief 读取图像中的一个矩形区域
+     */
+    virtual cv::Mat readRegion(const cv::Rect& region) = 0;
+};
+
+/**
+ * @brief 分块写入的结果接收端
+ * writeTile可能被多个线程同时调用，各次写入的区域互不重叠
+ */
+class TileSink {
+public:
+    virtual ~TileSink() {}
+
+    virtual void writeTile(const cv::Rect& region, const cv::Mat& tile) = 0;
+};
+
+/**
+ * @brief 以内存中的cv::Mat作为来源
+ */
+class MatTileSource : public TileSource {
+private:
+    cv::Mat image;
+
+public:
+    explicit MatTileSource(const cv::Mat& image);
+    cv::Size size() const override;
+    cv::Mat readRegion(const cv::Rect& region) override;
+};
+
+/**
+ * @brief 将分块结果拼接为一个cv::Mat
+ * 输出类型由第一个写入的分块决定（步骤可能改变通道数）
+ */
+class MatTileSink : public TileSink {
+private:
+    cv::Size imageSize;
+    cv::Mat result;
+    std::mutex allocationMutex;
+
+public:
+    explicit MatTileSink(const cv::Size& imageSize);
+    void writeTile(const cv::Rect& region, const cv::Mat& tile) override;
+    const cv::Mat& getResult() const;
+};
+
+/**
+ * @brief 将分块结果直接写入一个分块存储的TIFF文件，结果不需要整体驻留内存
+ * TIFF分块的边长等于处理分块的边长，因此必须是16的倍数；各分块可按任意顺序写入。
+ * 像素类型由第一个写入的分块决定，3/4通道按RGB/RGBA保存。超过4 GB的结果写为BigTIFF。
+ * 需要libtiff（编译时定义HAVE_TIFF），否则isAvailable()返回false，所有写入都失败。
+ */
+class TiffTileSink : public TileSink {
+private:
+    std::string path;
+    cv::Size imageSize;
+    int tileSize;
+    void* handle;               // TIFF*，第一个分块写入时打开
+    int type;
+    bool failed;
+    std::mutex mutex;           // libtiff的句柄不是线程安全的，写入串行
+
+public:
+    /**
+     * @param path 输出文件路径
+     * @param imageSize 整幅结果的尺寸
+     * @param tileSize 分块边长，必须与TileOptions::tileSize相同且为16的倍数
+     */
+    TiffTileSink(const std::string& path, const cv::Size& imageSize, int tileSize);
+    ~TiffTileSink();
+
+    void writeTile(const cv::Rect& region, const cv::Mat& tile) override;
+
+    /**
+     * @brief 写完目录并关闭文件，所有分块写入后调用一次
+     * @return 所有分块都写入成功返回true；没有写入任何分块时返回false
+     */
+    bool close();
+
+    /**
+     * @brief 编译时是否有libtiff
+     */
+    static bool isAvailable();
+};
+
+/**
+ * @brief 分块处理参数
+ */
+struct TileOptions {
+    int tileSize;       // 分块边长（不含重叠边）
+    int threads;        // 并行处理的分块数上限，0表示使用OpenCV线程池的大小（由可执行程序通过cv::setNumThreads设置）
+
+    TileOptions() : tileSize(1024), threads(0) {}
+};
+
+/**
+ * @brief 分块（out-of-core）流水线执行器
+ *
+ * 将图像切分为分块，每个分块向外扩展重叠边（halo）后依次执行各步骤的applyFunction，
+ * 再裁掉重叠边写入结果。重叠边取各步骤邻域半径之和，因此结果与整幅处理一致。
+ * 同时驻留内存的只有每个线程正在处理的一个分块，峰值内存约为 分块大小 × 线程数。
+ * 分块通过cv::parallel_for_在OpenCV线程池上并行，不修改全局线程设置。
+ * 依赖全局信息的步骤（全局直方图、Otsu、K-means、轮廓/连通域、测量等）无法分块。
+ */
+class TileProcessor {
+public:
+    /**
+     * @brief 步骤的邻域半径（像素）
+     * @return 重叠边大小，-1表示该步骤不能分块处理
+     */
+    static int haloFor(const PipelineStep& step);
+
+    /**
+     * @brief 所有步骤是否都能分块处理
+     */
+    static bool isTileable(const std::vector<PipelineStep>& steps);
+
+    /**
+     * @brief 依次执行所有步骤所需的总重叠边
+     */
+    static int totalHalo(const std::vector<PipelineStep>& steps);
+
+    /**
+     * @brief 从来源分块读取、处理并写入接收端
+     * @return 成功返回true；流水线包含不可分块的步骤时返回false且不做任何处理
+     */
+    static bool run(TileSource& source, TileSink& sink, const std::vector<PipelineStep>& steps, const TileOptions& options);
+
+    /**
+     * @brief 对内存中的图像执行流水线
+     * 连续的可分块步骤并行分块执行，不可分块的步骤对整幅图像执行
+     * @param measurements 可选，收集测量步骤的结果
+     */
+    static cv::Mat run(const cv::Mat& image, const std::vector<PipelineStep>& steps, const TileOptions& options,
+                       std::vector<MeasurementResult>* measurements = nullptr);
+
+private:
+    static int oddKernelRadius(double kernelSize);
+};
@@ -1,12 +1,102 @@
 #pragma once
 
 #include <opencv2/opencv.hpp>
+#include <cstdint>
 #include "PreProcessing.h"
 #include "Segmentation.h"
 #include "Morphology.h"
 #include "CleanUp.h"
 #include "Measurements.h"
 
+/**
+ * @brief 缩放后的三通道显示位图缓存
+ * 以(源图像, 版本号, 区域, 目标尺寸)为键，图像未变化时每帧直接复用，不再重新缩放和转换通道
+ */
+class ScaledImageCache {
+private:
+    cv::Mat source;             // 持有源图像，保证缓冲区地址不会被复用
+    uint64_t version;
+    cv::Size maxSize;
+    cv::Rect region;
+    cv::Mat bitmap;
+    double rangeMin;            // 非8位图像整幅的取值范围，拉伸到8位显示时使用
+    double rangeMax;
+
+public:
+    ScaledImageCache();
+
+    /**
+     * @brief 获取缩放到maxSize以内的三通道位图
+     * @param image 源图像
+     * @param version 源图像的版本号；原地修改过的图像需要新的版本号
+     * @param maxSize 最大显示尺寸
+     * @param region 可选，只显示图像中的这一区域；此时允许放大（最近邻，便于查看单个像素）
+     * @return 缓存的位图，只读
+     */
+    const cv::Mat& get(const cv::Mat& image, uint64_t version, const cv::Size& maxSize,
+                       const cv::Rect& region = cv::Rect());
+
+    void clear();
+};
+
+/**
+ * @brief 图像显示区的缩放与平移状态
+ * zoom为相对"整幅图像适应显示区"的倍数，1表示不缩放；center为可见区域的中心（图像坐标）。
+ * 主显示区和预览区共用同一视口，因此预览显示的是主显示区中正在查看的区域。
+ */
+class ImageViewport {
+private:
+    double zoom;
+    cv::Point2d center;
+    bool dragging;
+    cv::Point lastMouse;
+
+    static double fitScale(const cv::Size& imageSize, const cv::Size& viewSize);
+
+public:
+    static const double kMaxPixelScale;     // 最大放大倍数（显示像素/图像像素）
+
+    ImageViewport();
+
+    /**
+     * @brief 恢复为整幅图像
+     */
+    void reset();
+
+    bool isZoomed() const;
+
+    /**
+     * @brief 显示像素与图像像素之比
+     */
+    double pixelScale(const cv::Size& imageSize, const cv::Size& viewSize) const;
+
+    /**
+     * @brief 可见区域（图像坐标），未缩放时为整幅图像
+     */
+    cv::Rect visibleRect(const cv::Size& imageSize, const cv::Size& viewSize) const;
+
+    /**
+     * @brief 按倍数缩放，保持中心不变
+     */
+    void zoomBy(double factor, const cv::Size& imageSize, const cv::Size& viewSize);
+
+    /**
+     * @brief 缩放到指定的显示像素/图像像素之比，1为1:1
+     */
+    void zoomToPixelScale(double scale, const cv::Size& imageSize, const cv::Size& viewSize);
+
+    /**
+     * @brief 处理在显示区内按下并拖动的平移
+     * @param area 显示区在窗口中的位置
+     * @param mouse 鼠标位置
+     * @param pressed 本帧按下了左键
+     * @param down 左键处于按下状态
+     * @return 视口是否移动
+     */
+    bool handleDrag(const cv::Rect& area, const cv::Point& mouse, bool pressed, bool down,
+                    const cv::Size& imageSize, const cv::Size& viewSize);
+};
+
 /**
  * @brief UI组件和辅助函数类
  * 包含模态窗口渲染和UI辅助功能
@@ -40,8 +130,19 @@ public:
      * @param width 宽度
      * @param height 高度
      * @param previewImage 预览图像
+     * @param cache 可选，缩放结果的缓存，预览图像不变时跳过缩放
+     * @param region 可选，只显示预览图像中的这一区域（放大查看时）
+     */
+    static void renderPreviewArea(cv::Mat& frame, int x, int y, int width, int height, const cv::Mat& previewImage,
+                                  ScaledImageCache* cache = nullptr, const cv::Rect& region = cv::Rect());
+
+    /**
+     * @brief 渲染缩放按钮（-、+、Fit、1:1）和当前倍数
+     * @param height 按钮高度
+     * @return 视口是否改变
      */
-    static void renderPreviewArea(cv::Mat& frame, int x, int y, int width, int height, const cv::Mat& previewImage);
+    static bool renderZoomControls(cv::Mat& frame, int x, int y, int height, ImageViewport& viewport,
+                                   const cv::Size& imageSize, const cv::Size& viewSize);
 
     /**
      * @brief 渲染模态窗口按钮
@@ -59,14 +160,11 @@ public:
      * @param controlAreaX 控制区域X坐标
      * @param brightness 亮度参数引用
      * @param contrast 对比度参数引用
-     * @param prevBrightness 前一个亮度值引用
-     * @param prevContrast 前一个对比度值引用
      * @param currentFunction 当前功能
-     * @return 是否需要更新预览
+     * @return 是否点击了立即更新预览的按钮
      */
     static bool renderAdjustContrastParameters(cv::Mat& frame, int startY, int controlAreaX, 
                                              double& brightness, double& contrast,
-                                             double& prevBrightness, double& prevContrast,
                                              PreProcessingFunction currentFunction);
 
     /**
@@ -76,13 +174,12 @@ public:
      * @param controlAreaX 控制区域X坐标
      * @param histogramMethod 直方图方法引用
      * @param clipLimit 剪切限制引用
-     * @param prevClipLimit 前一个剪切限制值引用
      * @param currentFunction 当前功能
-     * @return 是否需要更新预览
+     * @return 是否点击了立即更新预览的按钮
      */
     static bool renderHistogramEqualizationParameters(cv::Mat& frame, int startY, int controlAreaX,
                                                      int& histogramMethod, double& clipLimit,
-                                                     double& prevClipLimit, PreProcessingFunction currentFunction);
+                                                     PreProcessingFunction currentFunction);
 
     /**
      * @brief 渲染Flatten Background参数控制
@@ -90,14 +187,31 @@ public:
      * @param startY 起始Y坐标
      * @param controlAreaX 控制区域X坐标
      * @param flattenKernelSize 核大小引用
-     * @param prevFlattenKernelSize 前一个核大小值引用
      * @param currentFunction 当前功能
-     * @return 是否需要更新预览
+     * @return 是否点击了立即更新预览的按钮
      */
     static bool renderFlattenBackgroundParameters(cv::Mat& frame, int startY, int controlAreaX,
-                                                 int& flattenKernelSize, int& prevFlattenKernelSize,
+                                                 int& flattenKernelSize,
                                                  PreProcessingFunction currentFunction);
 
+    /**
+     * @brief 渲染FFT Filter参数控制
+     * @param frame 主窗口frame
+     * @param startY 起始Y坐标
+     * @param controlAreaX 控制区域X坐标
+     * @param maskType 掩模类型引用 (FrequencyMaskType)
+     * @param cutoff 截止频率引用（带通为下限，陷波为半径）
+     * @param upperCutoff 带通上限引用
+     * @param notchX 陷波中心X引用
+     * @param notchY 陷波中心Y引用
+     * @param currentFunction 当前功能
+     * @return 是否点击了立即更新预览的按钮
+     */
+    static bool renderFFTFilterParameters(cv::Mat& frame, int startY, int controlAreaX,
+                                         int& maskType, double& cutoff, double& upperCutoff,
+                                         double& notchX, double& notchY,
+                                         PreProcessingFunction currentFunction);
+
     /**
      * @brief 渲染预处理功能选择界面
      * @param frame 主窗口frame
@@ -118,18 +232,20 @@ public:
      * @param histogramMethod 直方图方法引用
      * @param clipLimit 剪切限制引用
      * @param flattenKernelSize 核大小引用
-     * @param prevBrightness 前一个亮度值引用
-     * @param prevContrast 前一个对比度值引用
-     * @param prevClipLimit 前一个剪切限制值引用
-     * @param prevFlattenKernelSize 前一个核大小值引用
-     * @return 操作结果 (0=无, 1=返回, 2=更新预览)
+     * @param fftMaskType FFT掩模类型引用
+     * @param fftCutoff FFT截止频率引用
+     * @param fftUpperCutoff FFT带通上限引用
+     * @param fftNotchX FFT陷波中心X引用
+     * @param fftNotchY FFT陷波中心Y引用
+     * @return 操作结果 (0=无, 1=返回, 2=立即更新预览)
+     * 滑块的变化不在这里报告，由ParameterTracker按参数比较检测并限速
      */
     static int renderPreProcessingParameters(cv::Mat& frame, int controlAreaX, int controlAreaY,
                                            PreProcessingFunction currentFunction,
                                            double& brightness, double& contrast,
                                            int& histogramMethod, double& clipLimit, int& flattenKernelSize,
-                                           double& prevBrightness, double& prevContrast,
-                                           double& prevClipLimit, int& prevFlattenKernelSize);
+                                           int& fftMaskType, double& fftCutoff, double& fftUpperCutoff,
+                                           double& fftNotchX, double& fftNotchY);
 
     // Segmentation UI methods
     static SegmentationFunction renderSegmentationFunctionSelection(cv::Mat& frame, int controlAreaX, int controlAreaY);
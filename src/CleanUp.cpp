@@ -1,4 +1,6 @@
 #include "CleanUp.h"
+#include "Logger.h"
+#include "Profiler.h"
 #include <iostream>
 
 CleanUp::CleanUp() {
@@ -12,24 +14,24 @@ cv::Mat CleanUp::fillAllHoles(const cv::Mat& image, int minHoleSize, int fillMet
     cv::Mat result;
     cv::Mat binaryImage;
 
-    std::cout << "DEBUG: fillAllHoles starting with image size=" << image.size()
+    LOG_DEBUG("fillAllHoles starting with image size=" << image.size()
               << ", channels=" << image.channels() << ", minHoleSize=" << minHoleSize
-              << ", fillMethod=" << fillMethod << std::endl;
+              << ", fillMethod=" << fillMethod);
 
     // Use input image directly (assuming it's already processed by Segmentation)
     if (image.channels() == 1) {
         binaryImage = image.clone();
-        std::cout << "DEBUG: Using single-channel input image directly" << std::endl;
+        LOG_DEBUG("Using single-channel input image directly");
     } else if (image.channels() == 3) {
         // Convert to grayscale but don't threshold (assume it's already processed)
         cv::cvtColor(image, binaryImage, cv::COLOR_BGR2GRAY);
-        std::cout << "DEBUG: Converted 3-channel to single-channel (no thresholding)" << std::endl;
+        LOG_DEBUG("Converted 3-channel to single-channel (no thresholding)");
     } else {
         binaryImage = image.clone();
-        std::cout << "DEBUG: Using image as-is" << std::endl;
+        LOG_DEBUG("Using image as-is");
     }
 
-    std::cout << "DEBUG: Binary image created, size=" << binaryImage.size() << std::endl;
+    LOG_DEBUG("Binary image created, size=" << binaryImage.size());
 
     // Apply different fill methods
     switch (fillMethod) {
@@ -72,8 +74,8 @@ cv::Mat CleanUp::fillAllHoles(const cv::Mat& image, int minHoleSize, int fillMet
 
     // Keep result in same format as processing (single channel for binary images)
 
-    std::cout << "DEBUG: fillAllHoles completed, result size=" << result.size()
-              << ", channels=" << result.channels() << std::endl;
+    LOG_DEBUG("fillAllHoles completed, result size=" << result.size()
+              << ", channels=" << result.channels());
     return result;
 }
 
@@ -81,24 +83,24 @@ cv::Mat CleanUp::rejectFeatures(const cv::Mat& image, int minFeatureSize, int ma
     cv::Mat result;
     cv::Mat binaryImage;
 
-    std::cout << "DEBUG: rejectFeatures starting with image size=" << image.size()
+    LOG_DEBUG("rejectFeatures starting with image size=" << image.size()
               << ", channels=" << image.channels() << ", minFeatureSize=" << minFeatureSize
-              << ", maxFeatureSize=" << maxFeatureSize << ", rejectMethod=" << rejectMethod << std::endl;
+              << ", maxFeatureSize=" << maxFeatureSize << ", rejectMethod=" << rejectMethod);
 
     // Use input image directly (assuming it's already processed by Segmentation)
     if (image.channels() == 1) {
         binaryImage = image.clone();
-        std::cout << "DEBUG: Using single-channel input image directly" << std::endl;
+        LOG_DEBUG("Using single-channel input image directly");
     } else if (image.channels() == 3) {
         // Convert to grayscale but don't threshold (assume it's already processed)
         cv::cvtColor(image, binaryImage, cv::COLOR_BGR2GRAY);
-        std::cout << "DEBUG: Converted 3-channel to single-channel (no thresholding)" << std::endl;
+        LOG_DEBUG("Converted 3-channel to single-channel (no thresholding)");
     } else {
         binaryImage = image.clone();
-        std::cout << "DEBUG: Using image as-is" << std::endl;
+        LOG_DEBUG("Using image as-is");
     }
 
-    std::cout << "DEBUG: Binary image created for rejectFeatures" << std::endl;
+    LOG_DEBUG("Binary image created for rejectFeatures");
 
     switch (rejectMethod) {
         case 0: // Size-based rejection
@@ -109,7 +111,7 @@ cv::Mat CleanUp::rejectFeatures(const cv::Mat& image, int minFeatureSize, int ma
                 result = rejectFeaturesBySize(binaryImage, minFeatureSize, maxFeatureSize);
                 cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3, 3));
                 cv::morphologyEx(result, result, cv::MORPH_OPEN, kernel);
-                std::cout << "DEBUG: Applied morphological opening after size rejection" << std::endl;
+                LOG_DEBUG("Applied morphological opening after size rejection");
             }
             break;
         case 2: // Contour-based rejection with shape analysis
@@ -131,7 +133,7 @@ cv::Mat CleanUp::rejectFeatures(const cv::Mat& image, int minFeatureSize, int ma
                         acceptedCount++;
                     }
                 }
-                std::cout << "DEBUG: Contour-based rejection: " << acceptedCount << " features accepted out of " << contours.size() << std::endl;
+                LOG_DEBUG("Contour-based rejection: " << acceptedCount << " features accepted out of " << contours.size());
             }
             break;
         default:
@@ -141,8 +143,8 @@ cv::Mat CleanUp::rejectFeatures(const cv::Mat& image, int minFeatureSize, int ma
 
     // Keep result in same format as processing (single channel for binary images)
 
-    std::cout << "DEBUG: rejectFeatures completed, result size=" << result.size()
-              << ", channels=" << result.channels() << std::endl;
+    LOG_DEBUG("rejectFeatures completed, result size=" << result.size()
+              << ", channels=" << result.channels());
     return result;
 }
 
@@ -150,8 +152,8 @@ cv::Mat CleanUp::rejectFeatures(const cv::Mat& image, int minFeatureSize, int ma
 cv::Mat CleanUp::findAndFillHoles(const cv::Mat& image, int minSize) {
     cv::Mat result = image.clone();
 
-    std::cout << "DEBUG: findAndFillHoles - input image size=" << image.size()
-              << ", type=" << image.type() << ", minSize=" << minSize << std::endl;
+    LOG_DEBUG("findAndFillHoles - input image size=" << image.size()
+              << ", type=" << image.type() << ", minSize=" << minSize);
 
     // Method 1: Use flood fill from borders to find holes
     cv::Mat temp = result.clone();
@@ -171,7 +173,7 @@ cv::Mat CleanUp::findAndFillHoles(const cv::Mat& image, int minSize) {
     std::vector<std::vector<cv::Point>> contours;
     cv::findContours(holes, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
 
-    std::cout << "DEBUG: Found " << contours.size() << " potential holes using flood fill method" << std::endl;
+    LOG_DEBUG("Found " << contours.size() << " potential holes using flood fill method");
 
     int filledCount = 0;
     // Fill holes larger than minSize
@@ -181,13 +183,13 @@ cv::Mat CleanUp::findAndFillHoles(const cv::Mat& image, int minSize) {
             // Fill the hole by drawing white on the original image
             cv::drawContours(result, contours, (int)i, cv::Scalar(255), -1);
             filledCount++;
-            std::cout << "DEBUG: Filled hole " << i << " with area=" << area << std::endl;
+            LOG_TRACE("Filled hole " << i << " with area=" << area);
         } else {
-            std::cout << "DEBUG: Skipped small hole " << i << " with area=" << area << " (< " << minSize << ")" << std::endl;
+            LOG_TRACE("Skipped small hole " << i << " with area=" << area << " (< " << minSize << ")");
         }
     }
 
-    std::cout << "DEBUG: Filled " << filledCount << " holes out of " << contours.size() << " candidates" << std::endl;
+    LOG_DEBUG("Filled " << filledCount << " holes out of " << contours.size() << " candidates");
     return result;
 }
 
@@ -198,8 +200,8 @@ cv::Mat CleanUp::rejectFeaturesBySize(const cv::Mat& image, int minSize, int max
     std::vector<std::vector<cv::Point>> contours;
     cv::findContours(image, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
 
-    std::cout << "DEBUG: rejectFeaturesBySize - found " << contours.size() << " features" << std::endl;
-    std::cout << "DEBUG: Size range: " << minSize << " - " << maxSize << std::endl;
+    LOG_DEBUG("rejectFeaturesBySize - found " << contours.size() << " features");
+    LOG_DEBUG("Size range: " << minSize << " - " << maxSize);
 
     int acceptedCount = 0;
     // Keep only features within size range
@@ -208,18 +210,19 @@ cv::Mat CleanUp::rejectFeaturesBySize(const cv::Mat& image, int minSize, int max
         if (area >= minSize && area <= maxSize) {
             cv::drawContours(result, contours, (int)i, cv::Scalar(255), -1);
             acceptedCount++;
-            std::cout << "DEBUG: Accepted feature " << i << " with area=" << area << std::endl;
+            LOG_TRACE("Accepted feature " << i << " with area=" << area);
         } else {
-            std::cout << "DEBUG: Rejected feature " << i << " with area=" << area << std::endl;
+            LOG_TRACE("Rejected feature " << i << " with area=" << area);
         }
     }
 
-    std::cout << "DEBUG: Accepted " << acceptedCount << " features out of " << contours.size() << std::endl;
+    LOG_DEBUG("Accepted " << acceptedCount << " features out of " << contours.size());
     return result;
 }
 
 // 统一的应用函数
 cv::Mat CleanUp::applyFunction(const cv::Mat& image, CleanUpFunction function, const std::vector<double>& params) {
+    ScopedTimer timer("CleanUp #" + std::to_string((int)function));
     switch (function) {
         case CleanUpFunction::FILL_ALL_HOLES:
             return fillAllHoles(image, 
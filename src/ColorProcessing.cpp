@@ -0,0 +1,134 @@
+#include "ColorProcessing.h"
+#include "Profiler.h"
+#include <iostream>
+
+ColorProcessing::ColorProcessing() {
+}
+
+ColorProcessing::~ColorProcessing() {
+}
+
+cv::Mat ColorProcessing::convertToGrayscale(const cv::Mat& image) {
+    if (image.channels() != 3) {
+        std::cout << "Image is already grayscale (channels=" << image.channels() << ")" << std::endl;
+        return image;
+    }
+
+    cv::Mat grayImage;
+    cv::cvtColor(image, grayImage, cv::COLOR_BGR2GRAY);
+    return grayImage;
+}
+
+cv::Mat ColorProcessing::colorSelect(const cv::Mat& image, int hue_min, int hue_max, int sat_min, int sat_max, int val_min, int val_max) {
+    // Color selection only works on 3-channel images
+    if (image.channels() != 3) {
+        std::cout << "WARNING: Color selection requires 3-channel image, current has " << image.channels() << " channels" << std::endl;
+        return image;
+    }
+
+    cv::Mat hsv, mask;
+    cv::cvtColor(image, hsv, cv::COLOR_BGR2HSV);
+
+    cv::Scalar lower(hue_min, sat_min, val_min);
+    cv::Scalar upper(hue_max, sat_max, val_max);
+    cv::inRange(hsv, lower, upper, mask);
+
+    // Initialize result with zeros and same type as input
+    cv::Mat result = cv::Mat::zeros(image.size(), image.type());
+    image.copyTo(result, mask);
+    return result;
+}
+
+cv::Mat ColorProcessing::colorCluster(const cv::Mat& image, int k) {
+    // Color clustering only works on 3-channel images
+    if (image.channels() != 3) {
+        std::cout << "WARNING: Color clustering requires 3-channel image, current has " << image.channels() << " channels" << std::endl;
+        return image;
+    }
+
+    return performKMeans(image, k);
+}
+
+cv::Mat ColorProcessing::colorDeconvolution(const cv::Mat& image, int channel) {
+    // Color deconvolution only works on 3-channel images
+    if (image.channels() != 3) {
+        std::cout << "WARNING: Color deconvolution requires 3-channel image, current has " << image.channels() << " channels" << std::endl;
+        return image;
+    }
+
+    std::vector<cv::Mat> channels;
+    cv::split(image, channels);
+
+    if (channel >= 0 && channel < (int)channels.size()) {
+        // Extract single channel and keep as grayscale (1-channel)
+        return channels[channel];
+    }
+    return image;
+}
+
+cv::Mat ColorProcessing::channelOperation(const cv::Mat& image, int operation, double value) {
+    cv::Mat result;
+    switch (operation) {
+        case 0:
+            cv::add(image, cv::Scalar::all(value), result);
+            break;
+        case 1:
+            cv::subtract(image, cv::Scalar::all(value), result);
+            break;
+        case 2:
+            cv::multiply(image, cv::Scalar::all(value), result);
+            break;
+        case 3:
+            cv::divide(image, cv::Scalar::all(value), result);
+            break;
+        default:
+            result = image.clone();
+            break;
+    }
+    return result;
+}
+
+cv::Mat ColorProcessing::performKMeans(const cv::Mat& image, int k) {
+    cv::Mat data;
+    image.reshape(1, image.rows * image.cols).convertTo(data, CV_32F);
+
+    cv::Mat labels, centers;
+    cv::kmeans(data, k, labels, cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 20, 1.0), 3, cv::KMEANS_PP_CENTERS, centers);
+
+    cv::Mat result(image.size(), image.type());
+    for (int i = 0; i < image.rows * image.cols; i++) {
+        int cluster = labels.at<int>(i);
+        if (image.channels() == 1) {
+            result.at<uchar>(i / image.cols, i % image.cols) = static_cast<uchar>(centers.at<float>(cluster, 0));
+        } else {
+            cv::Vec3b color(static_cast<uchar>(centers.at<float>(cluster, 0)),
+                           static_cast<uchar>(centers.at<float>(cluster, 1)),
+                           static_cast<uchar>(centers.at<float>(cluster, 2)));
+            result.at<cv::Vec3b>(i / image.cols, i % image.cols) = color;
+        }
+    }
+
+    return result;
+}
+
+// 统一的应用函数
+cv::Mat ColorProcessing::applyFunction(const cv::Mat& image, ColorFunction function, const std::vector<double>& params) {
+    ScopedTimer timer("Color #" + std::to_string((int)function));
+    switch (function) {
+        case ColorFunction::CONVERT_GRAYSCALE:
+            return convertToGrayscale(image);
+        case ColorFunction::COLOR_SELECT:
+            return colorSelect(image,
+                               params.size() > 0 ? (int)params[0] : 0, params.size() > 1 ? (int)params[1] : 179,
+                               params.size() > 2 ? (int)params[2] : 0, params.size() > 3 ? (int)params[3] : 255,
+                               params.size() > 4 ? (int)params[4] : 0, params.size() > 5 ? (int)params[5] : 255);
+        case ColorFunction::COLOR_CLUSTER:
+            return colorCluster(image, params.size() > 0 ? (int)params[0] : 3);
+        case ColorFunction::COLOR_DECONVOLUTION:
+            return colorDeconvolution(image, params.size() > 0 ? (int)params[0] : 0);
+        case ColorFunction::CHANNEL_OPERATION:
+            return channelOperation(image, params.size() > 0 ? (int)params[0] : 0, params.size() > 1 ? params[1] : 1.0);
+        default:
+            return image.clone();
+    }
+}
@@ -0,0 +1,790 @@
+#include "FilterKernels.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+const int FilterKernels::kMaxMedianKernel = 255;
+
+namespace {
+
+const int kCoarseBins = 16;
+const int kFineBins = 256;
+const int kFinePerCoarse = kFineBins / kCoarseBins;
+
+// 每个条带至少包含的核高度倍数，条带开头需要重新累积列直方图
+const int kMinStripKernels = 4;
+
+inline int clampIndex(int index, int size) {
+    return std::min(std::max(index, 0), size - 1);
+}
+
+// BORDER_REFLECT_101对应的下标（与cv::blur等OpenCV滤波的默认边界一致），窗口可以比图像大
+inline int reflectIndex(int index, int size) {
+    return (unsigned)index < (unsigned)size ? index : cv::borderInterpolate(index, size, cv::BORDER_REFLECT_101);
+}
+
+// 固定长度的16位加减，编译器会将其向量化
+inline void addSubtract16(uint16_t* target, const uint16_t* add, const uint16_t* subtract) {
+    for (int i = 0; i < kFinePerCoarse; i++) {
+        target[i] = (uint16_t)(target[i] + add[i] - subtract[i]);
+    }
+}
+
+/**
+ * @brief 对单通道8位图像的[rowBegin, rowEnd)行做中值滤波
+ */
+void medianRows8u(const cv::Mat& src, cv::Mat& dst, int radius, int rowBegin, int rowEnd) {
+    const int width = src.cols;
+    const int height = src.rows;
+    const int kernel = 2 * radius + 1;
+    // 中值是累积计数首次超过该值的灰度
+    const int threshold = (kernel * kernel - 1) / 2;
+
+    std::vector<uint16_t> columnCoarse((size_t)width * kCoarseBins, 0);
+    std::vector<uint16_t> columnFine((size_t)width * kFineBins, 0);
+
+    // 条带第一行的列直方图
+    for (int dy = -radius; dy <= radius; dy++) {
+        const uchar* row = src.ptr<uchar>(clampIndex(rowBegin + dy, height));
+        for (int x = 0; x < width; x++) {
+            columnCoarse[(size_t)x * kCoarseBins + (row[x] >> 4)]++;
+            columnFine[(size_t)x * kFineBins + row[x]]++;
+        }
+    }
+
+    uint16_t coarse[kCoarseBins];
+    uint16_t fine[kFineBins];
+    int fineSyncedAt[kCoarseBins];
+
+    for (int y = rowBegin; y < rowEnd; y++) {
+        if (y > rowBegin) {
+            // 列直方图下移一行：去掉离开窗口的一行，加入进入窗口的一行
+            const uchar* leaving = src.ptr<uchar>(clampIndex(y - radius - 1, height));
+            const uchar* entering = src.ptr<uchar>(clampIndex(y + radius, height));
+            for (int x = 0; x < width; x++) {
+                if (leaving[x] != entering[x]) {
+                    columnCoarse[(size_t)x * kCoarseBins + (leaving[x] >> 4)]--;
+                    columnCoarse[(size_t)x * kCoarseBins + (entering[x] >> 4)]++;
+                    columnFine[(size_t)x * kFineBins + leaving[x]]--;
+                    columnFine[(size_t)x * kFineBins + entering[x]]++;
+                }
+            }
+        }
+
+        // x = 0处的核直方图，左侧超出边界的列重复第0列
+        for (int b = 0; b < kCoarseBins; b++) {
+            coarse[b] = (uint16_t)(columnCoarse[b] * (radius + 1));
+            fineSyncedAt[b] = 0;
+        }
+        for (int v = 0; v < kFineBins; v++) {
+            fine[v] = (uint16_t)(columnFine[v] * (radius + 1));
+        }
+        for (int c = 1; c <= radius; c++) {
+            const uint16_t* columnC = &columnCoarse[(size_t)clampIndex(c, width) * kCoarseBins];
+            const uint16_t* columnF = &columnFine[(size_t)clampIndex(c, width) * kFineBins];
+            for (int b = 0; b < kCoarseBins; b++) {
+                coarse[b] = (uint16_t)(coarse[b] + columnC[b]);
+            }
+            for (int v = 0; v < kFineBins; v++) {
+                fine[v] = (uint16_t)(fine[v] + columnF[v]);
+            }
+        }
+
+        uchar* out = dst.ptr<uchar>(y);
+        for (int x = 0; x < width; x++) {
+            if (x > 0) {
+                addSubtract16(coarse, &columnCoarse[(size_t)clampIndex(x + radius, width) * kCoarseBins],
+                              &columnCoarse[(size_t)clampIndex(x - radius - 1, width) * kCoarseBins]);
+            }
+
+            // 在粗桶中定位中值所在的段
+            int sum = 0;
+            int b = 0;
+            while (b < kCoarseBins - 1 && sum + coarse[b] <= threshold) {
+                sum += coarse[b];
+                b++;
+            }
+
+            // 只同步这一段的细桶：落后较少时逐列增量更新，否则直接重新累加窗口内的列
+            uint16_t* segment = &fine[b * kFinePerCoarse];
+            int lag = x - fineSyncedAt[b];
+            if (lag > kernel) {
+                std::fill(segment, segment + kFinePerCoarse, (uint16_t)0);
+                for (int c = x - radius; c <= x + radius; c++) {
+                    const uint16_t* column = &columnFine[(size_t)clampIndex(c, width) * kFineBins + b * kFinePerCoarse];
+                    for (int i = 0; i < kFinePerCoarse; i++) {
+                        segment[i] = (uint16_t)(segment[i] + column[i]);
+                    }
+                }
+            } else {
+                for (int j = fineSyncedAt[b] + 1; j <= x; j++) {
+                    addSubtract16(segment, &columnFine[(size_t)clampIndex(j + radius, width) * kFineBins + b * kFinePerCoarse],
+                                  &columnFine[(size_t)clampIndex(j - radius - 1, width) * kFineBins + b * kFinePerCoarse]);
+                }
+            }
+            fineSyncedAt[b] = x;
+
+            int v = 0;
+            while (v < kFinePerCoarse - 1 && sum + segment[v] <= threshold) {
+                sum += segment[v];
+                v++;
+            }
+            out[x] = (uchar)(b * kFinePerCoarse + v);
+        }
+    }
+}
+
+/**
+ * @brief 按行条带并行执行rowsFn(rowBegin, rowEnd)
+ * 条带开头要重新累积核高度的行，因此条带数受核大小限制
+ */
+template <typename RowsFn>
+void forEachRowStrip(int rows, int kernel, const RowsFn& rowsFn) {
+    int strips = std::max(1, std::min(cv::getNumThreads(), rows / (kMinStripKernels * kernel)));
+    int rowsPerStrip = (rows + strips - 1) / strips;
+
+    cv::parallel_for_(cv::Range(0, strips), [&](const cv::Range& range) {
+        for (int strip = range.start; strip < range.end; strip++) {
+            int rowBegin = strip * rowsPerStrip;
+            int rowEnd = std::min(rows, rowBegin + rowsPerStrip);
+            if (rowBegin < rowEnd) {
+                rowsFn(rowBegin, rowEnd);
+            }
+        }
+    });
+}
+
+void median8uChannel(const cv::Mat& src, cv::Mat& dst, int radius) {
+    dst.create(src.size(), CV_8UC1);
+    forEachRowStrip(src.rows, 2 * radius + 1, [&](int rowBegin, int rowEnd) {
+        medianRows8u(src, dst, radius, rowBegin, rowEnd);
+    });
+}
+
+/**
+ * @brief [rowBegin, rowEnd)行的局部均值和方差，逐像素交给store(y, x, mean, variance)
+ * 每列维护窗口内的和与平方和，逐行只加入一行、去掉一行；再沿行滑动求窗口和。
+ * 整数输入用64位整数累加，结果精确，不会像8位乘法那样饱和。
+ */
+template <typename T, typename Acc, typename Store>
+void momentRows(const cv::Mat& src, int radius, int rowBegin, int rowEnd, const Store& store) {
+    const int width = src.cols;
+    const int height = src.rows;
+    const int kernel = 2 * radius + 1;
+    const double area = (double)kernel * kernel;
+
+    std::vector<Acc> columnSum(width, 0);
+    std::vector<Acc> columnSquares(width, 0);
+    for (int dy = -radius; dy <= radius; dy++) {
+        const T* row = src.ptr<T>(reflectIndex(rowBegin + dy, height));
+        for (int x = 0; x < width; x++) {
+            Acc v = (Acc)row[x];
+            columnSum[x] += v;
+            columnSquares[x] += v * v;
+        }
+    }
+
+    for (int y = rowBegin; y < rowEnd; y++) {
+        if (y > rowBegin) {
+            const T* leaving = src.ptr<T>(reflectIndex(y - radius - 1, height));
+            const T* entering = src.ptr<T>(reflectIndex(y + radius, height));
+            for (int x = 0; x < width; x++) {
+                Acc out = (Acc)leaving[x];
+                Acc in = (Acc)entering[x];
+                columnSum[x] += in - out;
+                columnSquares[x] += in * in - out * out;
+            }
+        }
+
+        // x = 0处的窗口，左侧超出边界的列按镜像取
+        Acc sum = 0;
+        Acc squares = 0;
+        for (int c = -radius; c <= radius; c++) {
+            sum += columnSum[reflectIndex(c, width)];
+            squares += columnSquares[reflectIndex(c, width)];
+        }
+
+        for (int x = 0; x < width; x++) {
+            if (x > 0) {
+                int entering = reflectIndex(x + radius, width);
+                int leaving = reflectIndex(x - radius - 1, width);
+                sum += columnSum[entering] - columnSum[leaving];
+                squares += columnSquares[entering] - columnSquares[leaving];
+            }
+            double m = (double)sum / area;
+            store(y, x, m, std::max(0.0, (double)squares / area - m * m));
+        }
+    }
+}
+
+template <typename T, typename Acc, typename Store>
+void momentsTyped(const cv::Mat& src, int radius, const Store& store) {
+    forEachRowStrip(src.rows, 2 * radius + 1, [&](int rowBegin, int rowEnd) {
+        momentRows<T, Acc>(src, radius, rowBegin, rowEnd, store);
+    });
+}
+
+/**
+ * @brief 按输入的位深选择累加类型，对单通道图像的每个像素调用store(y, x, mean, variance)
+ */
+template <typename Store>
+void forEachMoment(const cv::Mat& image, int kernelSize, const Store& store) {
+    CV_Assert(image.channels() == 1 && kernelSize % 2 == 1 && kernelSize >= 1);
+    int radius = kernelSize / 2;
+    switch (image.depth()) {
+        case CV_8U: momentsTyped<uchar, int64_t>(image, radius, store); break;
+        case CV_8S: momentsTyped<schar, int64_t>(image, radius, store); break;
+        case CV_16U: momentsTyped<ushort, int64_t>(image, radius, store); break;
+        case CV_16S: momentsTyped<short, int64_t>(image, radius, store); break;
+        // 32位整数的平方和可能超出64位整数，改用double累加
+        case CV_32S: momentsTyped<int, double>(image, radius, store); break;
+        case CV_32F: momentsTyped<float, double>(image, radius, store); break;
+        case CV_64F: momentsTyped<double, double>(image, radius, store); break;
+        default:
+            CV_Error(cv::Error::StsUnsupportedFormat, "Local statistics support 8U, 8S, 16U, 16S, 32S, 32F and 64F images");
+    }
+}
+
+/**
+ * @brief [rowBegin, rowEnd)行的窗口和，逐像素交给store(y, x, sum)
+ * 与momentRows相同的列和滑动，只累加一阶和
+ */
+template <typename T, typename Acc, typename Store>
+void sumRows(const cv::Mat& src, int radius, int rowBegin, int rowEnd, const Store& store) {
+    const int width = src.cols;
+    const int height = src.rows;
+
+    std::vector<Acc> columnSum(width, 0);
+    for (int dy = -radius; dy <= radius; dy++) {
+        const T* row = src.ptr<T>(reflectIndex(rowBegin + dy, height));
+        for (int x = 0; x < width; x++) {
+            columnSum[x] += (Acc)row[x];
+        }
+    }
+
+    for (int y = rowBegin; y < rowEnd; y++) {
+        if (y > rowBegin) {
+            const T* leaving = src.ptr<T>(reflectIndex(y - radius - 1, height));
+            const T* entering = src.ptr<T>(reflectIndex(y + radius, height));
+            for (int x = 0; x < width; x++) {
+                columnSum[x] += (Acc)entering[x] - (Acc)leaving[x];
+            }
+        }
+
+        Acc sum = 0;
+        for (int c = -radius; c <= radius; c++) {
+            sum += columnSum[reflectIndex(c, width)];
+        }
+
+        for (int x = 0; x < width; x++) {
+            if (x > 0) {
+                sum += columnSum[reflectIndex(x + radius, width)] - columnSum[reflectIndex(x - radius - 1, width)];
+            }
+            store(y, x, sum);
+        }
+    }
+}
+
+template <typename T, typename Acc, typename Store>
+void sumsTyped(const cv::Mat& src, int radius, const Store& store) {
+    forEachRowStrip(src.rows, 2 * radius + 1, [&](int rowBegin, int rowEnd) {
+        sumRows<T, Acc>(src, radius, rowBegin, rowEnd, store);
+    });
+}
+
+template <typename Out>
+cv::Mat boxSumTyped(const cv::Mat& src, int kernelSize, double scale) {
+    CV_Assert(kernelSize % 2 == 1 && kernelSize >= 1);
+    cv::Mat dst(src.size(), cv::DataType<Out>::type);
+    int radius = kernelSize / 2;
+    // 整数累加结果精确，只在写出时乘以scale并饱和截断
+    auto storeInteger = [&dst, scale](int y, int x, int64_t sum) {
+        dst.ptr<Out>(y)[x] = cv::saturate_cast<Out>(sum * scale);
+    };
+    auto storeFloat = [&dst, scale](int y, int x, double sum) {
+        dst.ptr<Out>(y)[x] = cv::saturate_cast<Out>(sum * scale);
+    };
+    switch (src.depth()) {
+        case CV_8U: sumsTyped<uchar, int64_t>(src, radius, storeInteger); break;
+        case CV_8S: sumsTyped<schar, int64_t>(src, radius, storeInteger); break;
+        case CV_16U: sumsTyped<ushort, int64_t>(src, radius, storeInteger); break;
+        case CV_16S: sumsTyped<short, int64_t>(src, radius, storeInteger); break;
+        case CV_32S: sumsTyped<int, int64_t>(src, radius, storeInteger); break;
+        case CV_32F: sumsTyped<float, double>(src, radius, storeFloat); break;
+        case CV_64F: sumsTyped<double, double>(src, radius, storeFloat); break;
+        default:
+            CV_Error(cv::Error::StsUnsupportedFormat, "Box sums support 8U, 8S, 16U, 16S, 32S, 32F and 64F images");
+    }
+    return dst;
+}
+
+cv::Mat stdDevChannel(const cv::Mat& src, int kernelSize, int ddepth, double scale) {
+    cv::Mat dst(src.size(), CV_MAKETYPE(ddepth, 1));
+    if (ddepth == CV_8U) {
+        forEachMoment(src, kernelSize, [&dst, scale](int y, int x, double, double variance) {
+            dst.ptr<uchar>(y)[x] = cv::saturate_cast<uchar>(std::sqrt(variance) * scale);
+        });
+    } else {
+        forEachMoment(src, kernelSize, [&dst, scale](int y, int x, double, double variance) {
+            dst.ptr<float>(y)[x] = (float)(std::sqrt(variance) * scale);
+        });
+    }
+    return dst;
+}
+
+/**
+ * @brief Wiener增益：局部方差不超过噪声时输出局部均值，否则按 (σ²-ν²)/σ² 保留细节
+ */
+template <typename T>
+void wienerTyped(const cv::Mat& src, const cv::Mat& mean, const cv::Mat& variance, double noise, cv::Mat& dst) {
+    cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; y++) {
+            const T* in = src.ptr<T>(y);
+            const float* meanRow = mean.ptr<float>(y);
+            const float* varianceRow = variance.ptr<float>(y);
+            T* out = dst.ptr<T>(y);
+            for (int x = 0; x < src.cols; x++) {
+                double v = varianceRow[x];
+                double gain = v > noise ? (v - noise) / v : 0.0;
+                out[x] = cv::saturate_cast<T>(meanRow[x] + gain * (in[x] - meanRow[x]));
+            }
+        }
+    });
+}
+
+/**
+ * @brief 单通道8位图像[rowBegin, rowEnd)行的局部熵（比特）
+ * 每行从x = 0处的窗口直方图开始，向右每步去掉一列、加入一列。Σc·log₂c随计数的变化增量更新，
+ * 熵 = log₂N - Σc·log₂c / N（N为窗口面积），因此每像素开销与核高度成正比。
+ * @param plogp plogp[c] = c·log₂c，c = 0..N
+ */
+void entropyRows8u(const cv::Mat& src, int radius, const std::vector<double>& plogp, int rowBegin, int rowEnd,
+                   cv::Mat& dst) {
+    const int width = src.cols;
+    const int height = src.rows;
+    const int kernel = 2 * radius + 1;
+    const double area = (double)kernel * kernel;
+    const double logArea = std::log2(area);
+
+    std::vector<const uchar*> rows(kernel);
+    int histogram[256];
+
+    for (int y = rowBegin; y < rowEnd; y++) {
+        for (int i = 0; i < kernel; i++) {
+            rows[i] = src.ptr<uchar>(reflectIndex(y - radius + i, height));
+        }
+
+        std::fill(histogram, histogram + 256, 0);
+        for (int c = -radius; c <= radius; c++) {
+            int column = reflectIndex(c, width);
+            for (int i = 0; i < kernel; i++) {
+                histogram[rows[i][column]]++;
+            }
+        }
+        double sum = 0.0;
+        for (int v = 0; v < 256; v++) {
+            sum += plogp[histogram[v]];
+        }
+
+        float* out = dst.ptr<float>(y);
+        out[0] = (float)std::max(0.0, logArea - sum / area);
+        for (int x = 1; x < width; x++) {
+            int leaving = reflectIndex(x - radius - 1, width);
+            int entering = reflectIndex(x + radius, width);
+            if (leaving != entering) {
+                for (int i = 0; i < kernel; i++) {
+                    int a = rows[i][leaving];
+                    int b = rows[i][entering];
+                    if (a != b) {
+                        sum += plogp[histogram[a] - 1] - plogp[histogram[a]];
+                        histogram[a]--;
+                        sum += plogp[histogram[b] + 1] - plogp[histogram[b]];
+                        histogram[b]++;
+                    }
+                }
+            }
+            out[x] = (float)std::max(0.0, logArea - sum / area);
+        }
+    }
+}
+
+cv::Mat entropyChannel(const cv::Mat& src, int radius, const std::vector<double>& plogp) {
+    cv::Mat dst(src.size(), CV_32F);
+    // 每行独立，按行分给各线程
+    cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& range) {
+        entropyRows8u(src, radius, plogp, range.start, range.end, dst);
+    });
+    return dst;
+}
+
+cv::Mat wienerChannel(const cv::Mat& src, int kernelSize, double noiseVariance) {
+    cv::Mat mean, variance;
+    FilterKernels::localMoments(src, kernelSize, mean, variance);
+
+    // 未给出噪声方差时，与MATLAB wiener2相同，取全图局部方差的平均值
+    double noise = noiseVariance > 0 ? noiseVariance : cv::mean(variance)[0];
+
+    cv::Mat dst(src.size(), src.type());
+    switch (src.depth()) {
+        case CV_8U: wienerTyped<uchar>(src, mean, variance, noise, dst); break;
+        case CV_8S: wienerTyped<schar>(src, mean, variance, noise, dst); break;
+        case CV_16U: wienerTyped<ushort>(src, mean, variance, noise, dst); break;
+        case CV_16S: wienerTyped<short>(src, mean, variance, noise, dst); break;
+        case CV_32S: wienerTyped<int>(src, mean, variance, noise, dst); break;
+        case CV_32F: wienerTyped<float>(src, mean, variance, noise, dst); break;
+        default: wienerTyped<double>(src, mean, variance, noise, dst); break;
+    }
+    return dst;
+}
+
+// 递归高斯两端按BORDER_REFLECT_101延拓的长度（σ的倍数），递推的初始状态在这段距离内衰减到1e-3以下
+const double kRecursivePaddingSigmas = 4.0;
+// 递归高斯每个条带的列数，条带内各列的递推同时推进
+const int kRecursiveStripColumns = 64;
+
+/**
+ * @brief Deriche四阶递归高斯的差分方程系数
+ * 因果部分 y⁺[n] = Σb·x[n-k] - Σa·y⁺[n-k]，反因果部分 y⁻[n] = Σb'·x[n+k] - Σa·y⁻[n+k]，输出为两者之和
+ */
+struct DericheCoefficients {
+    double causal[4];       // 作用于x[n]..x[n-3]
+    double anticausal[4];   // 作用于x[n+1]..x[n+4]
+    double feedback[4];     // a₁..a₄
+    double causalGain;      // 常数输入时y⁺与x之比
+    double anticausalGain;
+};
+
+DericheCoefficients dericheCoefficients(double sigma) {
+    // h(n) ≈ Σ αₖ·exp(-λₖ|n|/σ)，四项的留数和极点取自Deriche (1993)
+    typedef std::complex<double> Complex;
+    static const Complex alpha[4] = {Complex(0.84, 1.8675), Complex(0.84, -1.8675),
+                                     Complex(-0.34015, -0.1299), Complex(-0.34015, 0.1299)};
+    static const Complex lambda[4] = {Complex(1.783, 0.6318), Complex(1.783, -0.6318),
+                                      Complex(1.723, 1.997), Complex(1.723, -1.997)};
+
+    // 因果部分的传递函数 Σ αₖ/(1 - βₖz⁻¹)，βₖ = exp(-λₖ/σ)，通分为 b(z)/a(z)
+    Complex beta[4];
+    for (int k = 0; k < 4; k++) {
+        beta[k] = std::exp(-lambda[k] / sigma);
+    }
+    Complex denominator[5] = {1.0, 0.0, 0.0, 0.0, 0.0};
+    for (int k = 0; k < 4; k++) {
+        for (int j = 4; j >= 1; j--) {
+            denominator[j] -= beta[k] * denominator[j - 1];
+        }
+    }
+    Complex numerator[4] = {0.0, 0.0, 0.0, 0.0};
+    for (int k = 0; k < 4; k++) {
+        Complex product[4] = {1.0, 0.0, 0.0, 0.0};
+        int degree = 0;
+        for (int m = 0; m < 4; m++) {
+            if (m == k) {
+                continue;
+            }
+            degree++;
+            for (int j = degree; j >= 1; j--) {
+                product[j] -= beta[m] * product[j - 1];
+            }
+        }
+        for (int j = 0; j < 4; j++) {
+            numerator[j] += alpha[k] * product[j];
+        }
+    }
+
+    // 共轭成对的极点使系数为实数；反因果部分是因果部分的镜像去掉n=0项
+    DericheCoefficients c;
+    double feedbackSum = 1.0;
+    double causalSum = 0.0;
+    double anticausalSum = 0.0;
+    for (int k = 0; k < 4; k++) {
+        c.feedback[k] = denominator[k + 1].real();
+        c.causal[k] = numerator[k].real();
+        feedbackSum += c.feedback[k];
+        causalSum += c.causal[k];
+    }
+    for (int k = 0; k < 4; k++) {
+        double next = k < 3 ? c.causal[k + 1] : 0.0;
+        c.anticausal[k] = next - c.feedback[k] * c.causal[0];
+        anticausalSum += c.anticausal[k];
+    }
+
+    // 归一化为单位直流增益，常数输入的输出等于输入
+    double gain = (causalSum + anticausalSum) / feedbackSum;
+    for (int k = 0; k < 4; k++) {
+        c.causal[k] /= gain;
+        c.anticausal[k] /= gain;
+    }
+    c.causalGain = causalSum / gain / feedbackSum;
+    c.anticausalGain = anticausalSum / gain / feedbackSum;
+    return c;
+}
+
+/**
+ * @brief 对单通道CV_32F图像的[columnBegin, columnEnd)列沿列方向做递归高斯
+ * 各列的递推同时推进，内层循环沿行内连续的列进行，编译器会将其向量化。
+ * 递推状态用double：σ较大时极点接近1，float的递推会发散。
+ */
+void dericheColumns(const cv::Mat& src, cv::Mat& dst, const DericheCoefficients& c, int padding,
+                    int columnBegin, int columnEnd) {
+    const int height = src.rows;
+    const int width = columnEnd - columnBegin;
+    const int total = height + 2 * padding;
+
+    // 第i个延拓行对应的源行，超出延拓范围时取端点行（递推的稳态初值）
+    auto inputRow = [&](int i) {
+        i = std::min(std::max(i, 0), total - 1);
+        return src.ptr<float>(cv::borderInterpolate(i - padding, height, cv::BORDER_REFLECT_101)) + columnBegin;
+    };
+
+    // 输出的四行历史轮换使用，新值写入最旧的一行
+    std::vector<double> history((size_t)4 * width);
+    double* y[4];
+    for (int k = 0; k < 4; k++) {
+        y[k] = &history[(size_t)k * width];
+    }
+
+    const double b0 = c.causal[0], b1 = c.causal[1], b2 = c.causal[2], b3 = c.causal[3];
+    const double a1 = c.feedback[0], a2 = c.feedback[1], a3 = c.feedback[2], a4 = c.feedback[3];
+
+    const float* first = inputRow(0);
+    for (int k = 0; k < 4; k++) {
+        for (int j = 0; j < width; j++) {
+            y[k][j] = first[j] * c.causalGain;
+        }
+    }
+
+    std::vector<float> causal((size_t)height * width);
+    for (int i = 0; i < total; i++) {
+        const float* x0 = inputRow(i);
+        const float* x1 = inputRow(i - 1);
+        const float* x2 = inputRow(i - 2);
+        const float* x3 = inputRow(i - 3);
+        double* y1 = y[0];
+        double* y2 = y[1];
+        double* y3 = y[2];
+        double* y4 = y[3];
+        for (int j = 0; j < width; j++) {
+            y4[j] = b0 * x0[j] + b1 * x1[j] + b2 * x2[j] + b3 * x3[j]
+                    - a1 * y1[j] - a2 * y2[j] - a3 * y3[j] - a4 * y4[j];
+        }
+        std::rotate(y, y + 3, y + 4);
+        if (i >= padding && i < padding + height) {
+            std::copy(y[0], y[0] + width, causal.begin() + (size_t)(i - padding) * width);
+        }
+    }
+
+    const double c1 = c.anticausal[0], c2 = c.anticausal[1], c3 = c.anticausal[2], c4 = c.anticausal[3];
+    const float* last = inputRow(total - 1);
+    for (int k = 0; k < 4; k++) {
+        for (int j = 0; j < width; j++) {
+            y[k][j] = last[j] * c.anticausalGain;
+        }
+    }
+
+    for (int i = total - 1; i >= padding; i--) {
+        const float* x1 = inputRow(i + 1);
+        const float* x2 = inputRow(i + 2);
+        const float* x3 = inputRow(i + 3);
+        const float* x4 = inputRow(i + 4);
+        double* y1 = y[0];
+        double* y2 = y[1];
+        double* y3 = y[2];
+        double* y4 = y[3];
+        for (int j = 0; j < width; j++) {
+            y4[j] = c1 * x1[j] + c2 * x2[j] + c3 * x3[j] + c4 * x4[j]
+                    - a1 * y1[j] - a2 * y2[j] - a3 * y3[j] - a4 * y4[j];
+        }
+        std::rotate(y, y + 3, y + 4);
+        if (i < padding + height) {
+            const float* forward = &causal[(size_t)(i - padding) * width];
+            float* out = dst.ptr<float>(i - padding) + columnBegin;
+            for (int j = 0; j < width; j++) {
+                out[j] = (float)(forward[j] + y[0][j]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief 单通道CV_32F图像沿列方向的递归高斯，按列条带并行
+ */
+cv::Mat dericheVertical(const cv::Mat& src, double sigma) {
+    DericheCoefficients c = dericheCoefficients(sigma);
+    int padding = (int)std::ceil(kRecursivePaddingSigmas * sigma);
+    cv::Mat dst(src.size(), CV_32F);
+
+    int strips = (src.cols + kRecursiveStripColumns - 1) / kRecursiveStripColumns;
+    cv::parallel_for_(cv::Range(0, strips), [&](const cv::Range& range) {
+        for (int strip = range.start; strip < range.end; strip++) {
+            int columnBegin = strip * kRecursiveStripColumns;
+            int columnEnd = std::min(src.cols, columnBegin + kRecursiveStripColumns);
+            dericheColumns(src, dst, c, padding, columnBegin, columnEnd);
+        }
+    });
+    return dst;
+}
+
+}
+
+void FilterKernels::localMoments(const cv::Mat& image, int kernelSize, cv::Mat& mean, cv::Mat& variance) {
+    mean.create(image.size(), CV_32F);
+    variance.create(image.size(), CV_32F);
+    if (image.empty()) {
+        return;
+    }
+
+    forEachMoment(image, kernelSize, [&mean, &variance](int y, int x, double m, double v) {
+        mean.ptr<float>(y)[x] = (float)m;
+        variance.ptr<float>(y)[x] = (float)v;
+    });
+}
+
+cv::Mat FilterKernels::localStdDev(const cv::Mat& image, int kernelSize, int ddepth, double scale) {
+    CV_Assert(ddepth == CV_8U || ddepth == CV_32F);
+    if (image.empty()) {
+        return cv::Mat();
+    }
+
+    cv::Mat result;
+    if (image.channels() == 1) {
+        result = stdDevChannel(image, kernelSize, ddepth, scale);
+    } else {
+        std::vector<cv::Mat> channels;
+        cv::split(image, channels);
+        for (cv::Mat& channel : channels) {
+            channel = stdDevChannel(channel, kernelSize, ddepth, scale);
+        }
+        cv::merge(channels, result);
+    }
+    return result;
+}
+
+cv::Mat FilterKernels::wiener(const cv::Mat& image, int kernelSize, double noiseVariance) {
+    CV_Assert(kernelSize % 2 == 1 && kernelSize >= 1);
+    if (image.empty()) {
+        return cv::Mat();
+    }
+
+    cv::Mat result;
+    if (image.channels() == 1) {
+        result = wienerChannel(image, kernelSize, noiseVariance);
+    } else {
+        std::vector<cv::Mat> channels;
+        cv::split(image, channels);
+        for (cv::Mat& channel : channels) {
+            channel = wienerChannel(channel, kernelSize, noiseVariance);
+        }
+        cv::merge(channels, result);
+    }
+    return result;
+}
+
+cv::Mat FilterKernels::entropy8u(const cv::Mat& image, int kernelSize) {
+    CV_Assert(image.depth() == CV_8U && kernelSize % 2 == 1 && kernelSize >= 1);
+    if (image.empty()) {
+        return cv::Mat();
+    }
+
+    // 窗口面积固定（边界按镜像处理），c·log₂c只需对0..N制表
+    int area = kernelSize * kernelSize;
+    std::vector<double> plogp(area + 1, 0.0);
+    for (int c = 1; c <= area; c++) {
+        plogp[c] = c * std::log2((double)c);
+    }
+
+    int radius = kernelSize / 2;
+    cv::Mat result;
+    if (image.channels() == 1) {
+        result = entropyChannel(image, radius, plogp);
+    } else {
+        std::vector<cv::Mat> channels;
+        cv::split(image, channels);
+        for (cv::Mat& channel : channels) {
+            channel = entropyChannel(channel, radius, plogp);
+        }
+        cv::merge(channels, result);
+    }
+    return result;
+}
+
+cv::Mat FilterKernels::median8u(const cv::Mat& image, int kernelSize) {
+    CV_Assert(image.depth() == CV_8U && kernelSize % 2 == 1 && kernelSize >= 3 && kernelSize <= kMaxMedianKernel);
+    if (image.empty()) {
+        return cv::Mat();
+    }
+
+    int radius = kernelSize / 2;
+    cv::Mat result;
+    if (image.channels() == 1) {
+        median8uChannel(image, result, radius);
+    } else {
+        std::vector<cv::Mat> channels;
+        cv::split(image, channels);
+        for (cv::Mat& channel : channels) {
+            cv::Mat filtered;
+            median8uChannel(channel, filtered, radius);
+            channel = filtered;
+        }
+        cv::merge(channels, result);
+    }
+
+    LOG_TRACE("FilterKernels::median8u - " << image.cols << "x" << image.rows << "x" << image.channels()
+              << ", kernel " << kernelSize);
+    return result;
+}
+
+cv::Mat FilterKernels::recursiveGaussian(const cv::Mat& image, double sigmaX, double sigmaY) {
+    CV_Assert(sigmaX > 0 && sigmaY > 0);
+    if (image.empty()) {
+        return cv::Mat();
+    }
+
+    // 各通道交错存放，按单通道处理时每个通道仍是独立的列；水平方向转置后复用列方向的递推
+    int channels = image.channels();
+    cv::Mat working;
+    image.convertTo(working, CV_32F);
+    cv::Mat vertical = dericheVertical(working.reshape(1), sigmaY);
+
+    cv::Mat transposed;
+    cv::transpose(vertical.reshape(channels), transposed);
+    cv::Mat horizontal = dericheVertical(transposed.reshape(1), sigmaX);
+    cv::transpose(horizontal.reshape(channels), working);
+
+    cv::Mat result;
+    working.convertTo(result, image.depth());
+
+    LOG_TRACE("FilterKernels::recursiveGaussian - " << image.cols << "x" << image.rows << "x" << channels
+              << ", sigma " << sigmaX << "/" << sigmaY);
+    return result;
+}
+
+cv::Mat FilterKernels::boxSum(const cv::Mat& image, int kernelSize, int ddepth, double scale) {
+    if (image.empty()) {
+        return cv::Mat();
+    }
+    if (ddepth < 0) {
+        ddepth = image.depth();
+    }
+
+    std::vector<cv::Mat> channels;
+    cv::split(image, channels);
+    for (cv::Mat& channel : channels) {
+        switch (ddepth) {
+            case CV_8U: channel = boxSumTyped<uchar>(channel, kernelSize, scale); break;
+            case CV_8S: channel = boxSumTyped<schar>(channel, kernelSize, scale); break;
+            case CV_16U: channel = boxSumTyped<ushort>(channel, kernelSize, scale); break;
+            case CV_16S: channel = boxSumTyped<short>(channel, kernelSize, scale); break;
+            case CV_32S: channel = boxSumTyped<int>(channel, kernelSize, scale); break;
+            case CV_32F: channel = boxSumTyped<float>(channel, kernelSize, scale); break;
+            case CV_64F: channel = boxSumTyped<double>(channel, kernelSize, scale); break;
+            default:
+                CV_Error(cv::Error::StsUnsupportedFormat, "Box sums write 8U, 8S, 16U, 16S, 32S, 32F or 64F output");
+        }
+    }
+    cv::Mat result;
+    cv::merge(channels, result);
+    return result;
+}
@@ -0,0 +1,173 @@
+#include "FrequencyFilter.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 截止频率的下限，避免高斯σ为0
+const double kMinCutoff = 1e-3;
+
+// 一个可分离的高斯项 exp(-|f-c|²/(2σ²)) 沿两个轴的因子
+struct SeparableTerm {
+    std::vector<float> x;
+    std::vector<float> y;
+};
+
+// DFT下标k对应的频率，以奈奎斯特频率为单位，范围[-1, 1]
+double frequencyAt(int k, int n) {
+    return (k <= n / 2 ? k : k - n) * 2.0 / n;
+}
+
+double gaussian(double f, double center, double sigma) {
+    double d = f - center;
+    return std::exp(-d * d / (2.0 * sigma * sigma));
+}
+
+SeparableTerm makeTerm(const cv::Size& size, double sigma, double centerX, double centerY) {
+    SeparableTerm term;
+    term.x.resize(size.width);
+    term.y.resize(size.height);
+    for (int u = 0; u < size.width; u++) {
+        term.x[u] = (float)gaussian(frequencyAt(u, size.width), centerX, sigma);
+    }
+    for (int v = 0; v < size.height; v++) {
+        term.y[v] = (float)gaussian(frequencyAt(v, size.height), centerY, sigma);
+    }
+    return term;
+}
+
+// 掩模由至多两个高斯项a、b组合而成
+void termSigmas(const FrequencyMask& mask, double& sigmaA, double& sigmaB) {
+    double cutoff = std::max(kMinCutoff, mask.cutoff);
+    double upper = std::max(kMinCutoff, mask.upperCutoff);
+    sigmaA = mask.type == FrequencyMaskType::BAND_PASS ? std::min(cutoff, upper) : cutoff;
+    sigmaB = mask.type == FrequencyMaskType::BAND_PASS ? std::max(cutoff, upper) : cutoff;
+}
+
+float combine(FrequencyMaskType type, float a, float b) {
+    switch (type) {
+        case FrequencyMaskType::HIGH_PASS:
+            return 1.0f - a;
+        case FrequencyMaskType::BAND_PASS:
+            return b - a;
+        case FrequencyMaskType::NOTCH:
+            return (1.0f - a) * (1.0f - b);
+        case FrequencyMaskType::LOW_PASS:
+        default:
+            return a;
+    }
+}
+
+bool keepsDC(FrequencyMaskType type) {
+    return type == FrequencyMaskType::HIGH_PASS || type == FrequencyMaskType::BAND_PASS;
+}
+
+}
+
+// 渐进式预览的粗、细两级，加上放大查看时的可见区域
+const size_t FrequencyFilter::kMaxCachedImages = 3;
+
+FrequencyFilter::FrequencyFilter() : generation(0) {
+}
+
+double FrequencyFilter::response(const FrequencyMask& mask, double fx, double fy) {
+    if (fx == 0 && fy == 0 && keepsDC(mask.type)) {
+        return 1.0;
+    }
+    double sigmaA, sigmaB;
+    termSigmas(mask, sigmaA, sigmaB);
+    bool notch = mask.type == FrequencyMaskType::NOTCH;
+    double a = gaussian(fx, notch ? mask.notchX : 0.0, sigmaA) * gaussian(fy, notch ? mask.notchY : 0.0, sigmaA);
+    double b = gaussian(fx, notch ? -mask.notchX : 0.0, sigmaB) * gaussian(fy, notch ? -mask.notchY : 0.0, sigmaB);
+    return combine(mask.type, (float)a, (float)b);
+}
+
+std::vector<cv::Mat> FrequencyFilter::spectraFor(const cv::Mat& image) {
+    uint64_t startGeneration;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            const cv::Mat& source = it->source;
+            if (source.data == image.data && source.size() == image.size() && source.type() == image.type() &&
+                source.step[0] == image.step[0]) {
+                entries.splice(entries.begin(), entries, it);
+                return entries.front().spectra;
+            }
+        }
+        startGeneration = generation;
+    }
+
+    // 正向变换在锁外计算，其他线程的缓存命中不被阻塞
+    cv::Size padded(cv::getOptimalDFTSize(image.cols), cv::getOptimalDFTSize(image.rows));
+    std::vector<cv::Mat> channels;
+    cv::split(image, channels);
+
+    std::vector<cv::Mat> result(channels.size());
+    for (size_t c = 0; c < channels.size(); c++) {
+        cv::Mat real;
+        channels[c].convertTo(real, CV_32F);
+        // 镜像补边，减小周期延拓在右边和下边造成的跳变
+        cv::copyMakeBorder(real, real, 0, padded.height - image.rows, 0, padded.width - image.cols, cv::BORDER_REFLECT);
+        cv::dft(real, result[c], cv::DFT_COMPLEX_OUTPUT);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (generation == startGeneration) {
+        entries.push_front(Entry{image, result});
+        if (entries.size() > kMaxCachedImages) {
+            entries.pop_back();
+        }
+        LOG_DEBUG("Cached FFT spectrum: " << image.cols << "x" << image.rows << " padded to "
+                  << padded.width << "x" << padded.height << ", " << channels.size() << " channel(s)");
+    }
+    return result;
+}
+
+cv::Mat FrequencyFilter::apply(const cv::Mat& image, const FrequencyMask& mask) {
+    if (image.empty()) {
+        return cv::Mat();
+    }
+
+    std::vector<cv::Mat> channelSpectra = spectraFor(image);
+    cv::Size padded = channelSpectra[0].size();
+
+    double sigmaA, sigmaB;
+    termSigmas(mask, sigmaA, sigmaB);
+    bool notch = mask.type == FrequencyMaskType::NOTCH;
+    SeparableTerm a = makeTerm(padded, sigmaA, notch ? mask.notchX : 0.0, notch ? mask.notchY : 0.0);
+    SeparableTerm b = makeTerm(padded, sigmaB, notch ? -mask.notchX : 0.0, notch ? -mask.notchY : 0.0);
+
+    std::vector<cv::Mat> channels(channelSpectra.size());
+    cv::Mat product(padded, CV_32FC2);
+    for (size_t c = 0; c < channelSpectra.size(); c++) {
+        // 掩模为实数，实部和虚部乘以同一个系数；缓存的频谱只读
+        for (int v = 0; v < padded.height; v++) {
+            const cv::Vec2f* in = channelSpectra[c].ptr<cv::Vec2f>(v);
+            cv::Vec2f* out = product.ptr<cv::Vec2f>(v);
+            float ay = a.y[v];
+            float by = b.y[v];
+            for (int u = 0; u < padded.width; u++) {
+                float h = combine(mask.type, ay * a.x[u], by * b.x[u]);
+                out[u] = in[u] * h;
+            }
+        }
+        if (keepsDC(mask.type)) {
+            product.at<cv::Vec2f>(0, 0) = channelSpectra[c].at<cv::Vec2f>(0, 0);
+        }
+
+        cv::Mat spatial;
+        cv::dft(product, spatial, cv::DFT_INVERSE | cv::DFT_SCALE | cv::DFT_REAL_OUTPUT);
+        spatial(cv::Rect(0, 0, image.cols, image.rows)).convertTo(channels[c], image.depth());
+    }
+
+    cv::Mat result;
+    cv::merge(channels, result);
+    return result;
+}
+
+void FrequencyFilter::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    generation++;
+}
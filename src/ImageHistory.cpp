@@ -0,0 +1,160 @@
+#include "ImageHistory.h"
+#include <iostream>
+#include <set>
+
+ImageHistory::ImageHistory(size_t memoryBudget, size_t maxEntries)
+    : currentIndex(-1), memoryBudget(memoryBudget), maxEntries(maxEntries) {
+}
+
+ImageHistory::~ImageHistory() {
+}
+
+void ImageHistory::reset(const cv::Mat& image, const cv::Mat& source, const std::vector<PipelineStep>& steps, const std::string& label) {
+    entries.clear();
+    currentIndex = -1;
+    push(image, source, steps, label);
+}
+
+void ImageHistory::push(const cv::Mat& image, const cv::Mat& source, const std::vector<PipelineStep>& steps, const std::string& label) {
+    // 丢弃重做分支
+    if (currentIndex + 1 < (int)entries.size()) {
+        entries.erase(entries.begin() + currentIndex + 1, entries.end());
+    }
+
+    HistoryEntry entry;
+    entry.image = image;
+    entry.source = source;
+    entry.steps = steps;
+    entry.label = label;
+    entries.push_back(entry);
+    currentIndex = (int)entries.size() - 1;
+
+    enforceBudget();
+}
+
+bool ImageHistory::canUndo() const {
+    return currentIndex > 0;
+}
+
+bool ImageHistory::canRedo() const {
+    return currentIndex >= 0 && currentIndex + 1 < (int)entries.size();
+}
+
+bool ImageHistory::undo() {
+    if (!canUndo()) {
+        return false;
+    }
+    currentIndex--;
+    return true;
+}
+
+bool ImageHistory::redo() {
+    if (!canRedo()) {
+        return false;
+    }
+    currentIndex++;
+    return true;
+}
+
+const HistoryEntry& ImageHistory::current() {
+    if (entries[currentIndex].image.empty() && !entries[currentIndex].compressed.empty()) {
+        decompressEntry(entries[currentIndex]);
+        enforceBudget();
+    }
+    return entries[currentIndex];
+}
+
+std::string ImageHistory::undoLabel() const {
+    return canUndo() ? entries[currentIndex].label : std::string();
+}
+
+std::string ImageHistory::redoLabel() const {
+    return canRedo() ? entries[currentIndex + 1].label : std::string();
+}
+
+bool ImageHistory::empty() const {
+    return entries.empty();
+}
+
+void ImageHistory::clear() {
+    entries.clear();
+    currentIndex = -1;
+}
+
+void ImageHistory::setMemoryBudget(size_t bytes) {
+    memoryBudget = bytes;
+    enforceBudget();
+}
+
+size_t ImageHistory::memoryUsage() const {
+    std::set<const uchar*> buffers;
+    size_t total = 0;
+    for (const HistoryEntry& entry : entries) {
+        for (const cv::Mat* mat : {&entry.image, &entry.source}) {
+            if (!mat->empty() && buffers.insert(mat->datastart).second) {
+                total += mat->dataend - mat->datastart;
+            }
+        }
+        total += entry.compressed.size();
+    }
+    return total;
+}
+
+void ImageHistory::enforceBudget() {
+    while (entries.size() > maxEntries && currentIndex > 0) {
+        entries.erase(entries.begin());
+        currentIndex--;
+    }
+
+    if (memoryUsage() <= memoryBudget) {
+        return;
+    }
+
+    // 从最旧的状态开始压缩；与其他状态共享缓冲区的图像压缩后不会释放内存，跳过
+    for (int i = 0; i < (int)entries.size() && memoryUsage() > memoryBudget; i++) {
+        if (i == currentIndex || entries[i].image.empty()) {
+            continue;
+        }
+
+        bool shared = false;
+        for (int j = 0; j < (int)entries.size() && !shared; j++) {
+            shared = (j != i && entries[j].image.datastart == entries[i].image.datastart) ||
+                     entries[j].source.datastart == entries[i].image.datastart;
+        }
+        if (!shared) {
+            compressEntry(entries[i]);
+        }
+    }
+
+    // 仍然超出预算时丢弃最旧的状态
+    while (memoryUsage() > memoryBudget && currentIndex > 0) {
+        entries.erase(entries.begin());
+        currentIndex--;
+    }
+}
+
+bool ImageHistory::compressEntry(HistoryEntry& entry) {
+    const cv::Mat& image = entry.image;
+    int channels = image.channels();
+    if ((image.depth() != CV_8U && image.depth() != CV_16U) || (channels != 1 && channels != 3 && channels != 4)) {
+        return false;
+    }
+
+    std::vector<uchar> buffer;
+    // 最低压缩级别：二值和分割结果压缩率已经很高，更高级别只会拖慢操作
+    if (!cv::imencode(".png", image, buffer, {cv::IMWRITE_PNG_COMPRESSION, 1})) {
+        return false;
+    }
+
+    std::cout << "History: compressed '" << entry.label << "' from " << image.total() * image.elemSize()
+              << " to " << buffer.size() << " bytes" << std::endl;
+    entry.compressed.swap(buffer);
+    entry.image.release();
+    return true;
+}
+
+void ImageHistory::decompressEntry(HistoryEntry& entry) {
+    entry.image = cv::imdecode(entry.compressed, cv::IMREAD_UNCHANGED);
+    entry.compressed.clear();
+    entry.compressed.shrink_to_fit();
+}
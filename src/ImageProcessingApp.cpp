@@ -2,12 +2,92 @@
 #include "ImageProcessingApp.h"
 #include "PreProcessing.h"
 #include "UIComponents.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "ParameterSweep.h"
+#include "TileProcessor.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #ifdef _WIN32
 #include <windows.h>
 #include <commdlg.h>
 #endif
 
+namespace {
+
+const cv::Scalar kBackgroundColor(49, 52, 49);
+
+// 有输入、后台任务或待绘制帧时的轮询间隔；空闲时逐次加倍直到上限
+const int kActiveWaitMs = 15;
+const int kMaxIdleWaitMs = 100;
+
+// 界面中的Sum Filter输出32位浮点的窗口和；只有kernelSize的旧配方保持输入位深
+const std::vector<double> kSumFilterParams = {5, 0, 1.0};
+
+// 渐进式预览最粗的级别，相对显示分辨率缩小2^level倍
+const int kCoarsePreviewLevel = 2;
+
+// 放大查看时只计算可见区域及其重叠边；无法分块的步骤在适应预览区的整幅代理图像上计算后裁剪
+PreviewResult computeVisiblePreview(const cv::Mat& source, const cv::Rect& visible, double viewScale,
+                                    const cv::Size& fitSize, const PipelineStep& step, ProxyPyramid* proxy,
+                                    const std::function<PreviewResult(const cv::Mat&, double)>& compute) {
+    cv::Size visibleSize(std::max(1, (int)std::lround(visible.width * viewScale)),
+                         std::max(1, (int)std::lround(visible.height * viewScale)));
+    double scale = ProxyPyramid::levelScale(visible.size(), visibleSize);
+    int halo = TileProcessor::haloFor(ProxyPyramid::scaleStep(step, scale));
+
+    PreviewResult result;
+    cv::Rect covered;
+    cv::Size inputSize;
+    if (halo < 0) {
+        double proxyScale = 1.0;
+        cv::Mat proxyImage = proxy->proxyFor(source, fitSize, &proxyScale);
+        result = compute(proxyImage, proxyScale);
+        covered = cv::Rect(cv::Point(), source.size());
+        inputSize = proxyImage.size();
+        scale = proxyScale;
+    } else {
+        int padding = (int)std::ceil(halo / scale);
+        covered = cv::Rect(visible.x - padding, visible.y - padding, visible.width + 2 * padding, visible.height + 2 * padding)
+                  & cv::Rect(cv::Point(), source.size());
+        cv::Mat input = source(covered);
+        if (scale < 1.0) {
+            cv::Mat reduced;
+            cv::resize(input, reduced, cv::Size(std::max(1, (int)std::lround(covered.width * scale)),
+                                                std::max(1, (int)std::lround(covered.height * scale))),
+                       0, 0, cv::INTER_AREA);
+            input = reduced;
+        }
+        result = compute(input, scale);
+        inputSize = input.size();
+    }
+
+    // 裁剪出可见部分；输出尺寸与输入不一致时保留整个结果
+    result.region = covered;
+    if (!result.image.empty() && result.image.size() == inputSize) {
+        cv::Rect core((int)std::floor((visible.x - covered.x) * scale), (int)std::floor((visible.y - covered.y) * scale),
+                      std::max(1, (int)std::lround(visible.width * scale)), std::max(1, (int)std::lround(visible.height * scale)));
+        core &= cv::Rect(cv::Point(), inputSize);
+        if (core.area() > 0) {
+            result.image = result.image(core);
+            result.region = visible;
+        }
+    }
+    return result;
+}
+
+// 参数扫描网格的格数
+const int kSweepCells = 16;
+
+// 每次输入后绘制的帧数。cvui控件在处理事件的那一帧才改变状态（如打开模态窗口），
+// 需要再画一帧才能显示结果
+const int kSettleFrames = 2;
+
+}
+
 ImageProcessingApp::ImageProcessingApp() : windowName("Image Processing Application") {
     initializeUI();
     
@@ -30,15 +110,17 @@ ImageProcessingApp::ImageProcessingApp() : windowName("Image Processing Applicat
     // 预处理参数
     brightness = 0.0;
     contrast = 1.0;
-    prevBrightness = brightness - 1;
-    prevContrast = contrast - 1;
     
     histogramMethod = 0;
     clipLimit = 2.0;
-    prevClipLimit = clipLimit - 1;
     
     flattenKernelSize = 15;
-    prevFlattenKernelSize = flattenKernelSize - 2;
+    
+    fftMaskType = 0;
+    fftCutoff = 0.16;
+    fftUpperCutoff = 0.5;
+    fftNotchX = 0.5;
+    fftNotchY = 0.0;
     
     // 分割参数
     thresholdValue = 127.0;
@@ -69,6 +151,9 @@ ImageProcessingApp::ImageProcessingApp() : windowName("Image Processing Applicat
     sensitivity = 0.5;
 
     isProcessing = false;
+    editingStepIndex = -1;
+    previewRefineLevel = 0;
+    sweepActive = false;
 }
 
 ImageProcessingApp::~ImageProcessingApp() {
@@ -80,23 +165,68 @@ void ImageProcessingApp::initialize() {
 }
 
 void ImageProcessingApp::run() {
+    // 帧缓冲区只分配一次，每次重绘前清空
+    frame.create(windowHeight, windowWidth, CV_8UC3);
+    int pendingFrames = kSettleFrames;
+    int waitMs = kActiveWaitMs;
+    cv::Point lastMouse(-1, -1);
+
     while (true) {
-        frame = cv::Mat(windowHeight, windowWidth, CV_8UC3, cv::Scalar(49, 52, 49));
-        
-        // 渲染主界面
-        renderMainInterface();
-        
-        // 渲染模态窗口
-        if (currentModal != ModalFunction::NONE) {
-            renderCurrentModal();
+        // 鼠标事件由cvui在waitKey期间记录，只在有输入时重绘
+        cv::Point mouse = cvui::mouse();
+        bool input = mouse != lastMouse || cvui::mouse(cvui::DOWN) || cvui::mouse(cvui::UP) || cvui::mouse(cvui::IS_DOWN);
+        lastMouse = mouse;
+        if (input) {
+            pendingFrames = kSettleFrames;
         }
-        
-        cvui::update();
-        cv::imshow(windowName, frame);
-        
-        if (cv::waitKey(20) == 27) { // ESC键退出
+
+        // 取回后台计算完成的预览
+        if (collectPreviewResult()) {
+            pendingFrames = std::max(pendingFrames, 1);
+        }
+
+        // 视口移动后重新计算可见区域的预览
+        if (updatePreviewViewport()) {
+            pendingFrames = std::max(pendingFrames, 1);
+        }
+
+        // 上一级预览完成且没有拖动时继续细化
+        if (refinePreview()) {
+            pendingFrames = std::max(pendingFrames, 1);
+        }
+
+        if (pendingFrames > 0) {
+            frame.setTo(kBackgroundColor);
+
+            // 渲染主界面
+            renderMainInterface();
+
+            // 渲染模态窗口
+            if (currentModal != ModalFunction::NONE) {
+                renderCurrentModal();
+            }
+
+            cvui::update();
+            cv::imshow(windowName, frame);
+            pendingFrames--;
+        }
+
+        // 参数变化后按函数的耗时限速提交预览
+        if (trackPreviewParameters()) {
+            pendingFrames = std::max(pendingFrames, 1);
+        }
+
+        bool active = input || pendingFrames > 0 || previewWorker.isBusy() || previewRefineLevel > 0 ||
+                      previewTracker.hasPending();
+        waitMs = active ? kActiveWaitMs : std::min(waitMs * 2, kMaxIdleWaitMs);
+
+        int key = cv::waitKey(waitMs);
+        if (key == 27) { // ESC键退出
             break;
         }
+        if (key != -1) {
+            pendingFrames = kSettleFrames;
+        }
     }
 }
 
@@ -141,23 +271,40 @@ void ImageProcessingApp::renderImageDisplay() {
                   cv::Scalar(200, 200, 200), 2);
 
     if (processor.hasImage()) {
-        cv::Mat displayImg = processor.getDisplayImage();
-        if (!displayImg.empty()) {
-            cv::Mat scaledImg = scaleImageToFit(displayImg);
-            if (!scaledImg.empty()) {
-                int imgX = imageDisplayX + (imageDisplayWidth - scaledImg.cols) / 2;
-                int imgY = imageDisplayY + (imageDisplayHeight - scaledImg.rows) / 2;
-
-                // 确保图像是3通道的，以避免cvui::image的copyTo错误
-                cv::Mat freshImage;
-                if (scaledImg.channels() == 1) {
-                    cv::cvtColor(scaledImg, freshImage, cv::COLOR_GRAY2BGR);
-                } else {
-                    freshImage = scaledImg.clone();
-                }
+        const cv::Mat& displayImg = processor.getDisplayImage();
+        cv::Size viewSize = mainViewSize();
+
+        // 模态窗口打开时主显示区被遮挡，只在预览区内拖动
+        if (currentModal == ModalFunction::NONE) {
+            cv::Rect area(imageDisplayX, imageDisplayY, imageDisplayWidth, imageDisplayHeight);
+            viewport.handleDrag(area, cvui::mouse(), cvui::mouse(cvui::DOWN), cvui::mouse(cvui::IS_DOWN),
+                                displayImg.size(), viewSize);
+        }
 
-                cvui::image(frame, imgX, imgY, freshImage);
-            }
+        // 图像版本和可见区域不变时复用上一帧的缩放结果，空闲时不再每帧重采样
+        cv::Rect visible = viewport.isZoomed() ? viewport.visibleRect(displayImg.size(), viewSize) : cv::Rect();
+        const cv::Mat& scaledImg = imageDisplayCache.get(displayImg, processor.getImageVersion(), viewSize, visible);
+        if (!scaledImg.empty()) {
+            int imgX = imageDisplayX + (imageDisplayWidth - scaledImg.cols) / 2;
+            int imgY = imageDisplayY + (imageDisplayHeight - scaledImg.rows) / 2;
+            cvui::image(frame, imgX, imgY, scaledImg);
+        }
+
+        if (currentModal == ModalFunction::NONE) {
+            UIComponents::renderZoomControls(frame, imageDisplayX, imageDisplayY + imageDisplayHeight + 10, 25, viewport,
+                                             displayImg.size(), viewSize);
+        }
+
+        // 超大图像只加载了金字塔的较小层级，处理与记录的参数都基于该尺寸，保存配方时换算回全分辨率
+        if (processor.getLoadScale() < 1.0) {
+            cv::Size fullSize = processor.getFullSize();
+            std::string scaleText = "Reduced resolution: " + std::to_string(displayImg.cols) + "x" +
+                                    std::to_string(displayImg.rows) + " of " + std::to_string(fullSize.width) + "x" +
+                                    std::to_string(fullSize.height) + " (" +
+                                    std::to_string((int)std::lround(100.0 * processor.getLoadScale())) +
+                                    "%); saved recipes are rescaled to full size";
+            cvui::text(frame, imageDisplayX, imageDisplayY + imageDisplayHeight + 45, scaleText.c_str(), 0.35,
+                       0xffd966);
         }
     } else {
         cvui::text(frame, imageDisplayX + imageDisplayWidth/2 - 50, imageDisplayY + imageDisplayHeight/2, "No image loaded", 0.35);
@@ -237,6 +384,36 @@ void ImageProcessingApp::renderControlPanel() {
     if (cvui::button(frame, controlPanelX, currentY, 150, 30, "Reset Image", 0.35)) {
         openModal(ModalFunction::RESET_IMAGE);
     }
+    currentY += 40;
+
+    // 流水线记录按钮
+    if (cvui::button(frame, controlPanelX, currentY, 150, 30, "Recipe", 0.35)) {
+        openModal(ModalFunction::RECIPE);
+    }
+    currentY += 40;
+
+    // 撤销/重做按钮
+    if (cvui::button(frame, controlPanelX, currentY, 72, 30, "Undo", 0.35)) {
+        undo();
+    }
+    if (cvui::button(frame, controlPanelX + 78, currentY, 72, 30, "Redo", 0.35)) {
+        redo();
+    }
+    currentY += 40;
+
+    if (!history.empty()) {
+        std::string historyText = "History: " + std::to_string(history.memoryUsage() / (1024 * 1024)) + " MB";
+        cvui::text(frame, controlPanelX, currentY, historyText.c_str(), 0.3);
+    }
+    currentY += 20;
+
+    // 导出计时统计
+    if (cvui::button(frame, controlPanelX, currentY, 150, 30, "Save Timings", 0.35)) {
+        std::string path = saveFileDialog("CSV Files\0*.csv\0All Files\0*.*\0", "csv");
+        if (!path.empty()) {
+            Profiler::dumpToFile(path);
+        }
+    }
 }
 
 void ImageProcessingApp::renderCurrentModal() {
@@ -277,6 +454,9 @@ void ImageProcessingApp::renderCurrentModal() {
         case ModalFunction::MEASUREMENTS:
             renderMeasurementsModal();
             break;
+        case ModalFunction::RECIPE:
+            renderRecipeModal();
+            break;
         default:
             break;
     }
@@ -284,6 +464,7 @@ void ImageProcessingApp::renderCurrentModal() {
 
 void ImageProcessingApp::openModal(ModalFunction modal) {
     currentModal = modal;
+    previewTracker.reset();
 
     // 重置相关状态
     switch (modal) {
@@ -309,30 +490,23 @@ void ImageProcessingApp::openModal(ModalFunction modal) {
 
 void ImageProcessingApp::closeModal() {
     currentModal = ModalFunction::NONE;
+    previewTracker.reset();
     currentPreProcessingFunction = PreProcessingFunction::NONE;
     currentSegmentationFunction = SegmentationFunction::NONE;
     currentMorphologyFunction = MorphologyFunction::NONE;
     currentCleanUpFunction = CleanUpFunction::NONE;
     currentMeasurementsFunction = MeasurementsFunction::NONE;
     previewImage = cv::Mat();
-}
-
-cv::Mat ImageProcessingApp::scaleImageToFit(const cv::Mat& image, int maxWidth, int maxHeight) {
-    if (image.empty()) {
-        return cv::Mat();
-    }
-
-    double scaleX = (double)maxWidth / image.cols;
-    double scaleY = (double)maxHeight / image.rows;
-    double scale = std::min(scaleX, scaleY);
-
-    if (scale >= 1.0) {
-        return image.clone();
-    }
-
-    cv::Mat scaledImage;
-    cv::resize(image, scaledImage, cv::Size(0, 0), scale, scale, cv::INTER_AREA);
-    return scaledImage;
+    previewWorker.cancel();
+    fftPreviewCache.clear();
+    previewCompute = nullptr;
+    previewRefineLevel = 0;
+    previewRegion = cv::Rect();
+    submittedPreviewView = cv::Rect();
+    sweepActive = false;
+    previewProxy.clear();
+    previewDisplayCache.clear();
+    editingStepIndex = -1;
 }
 
 void ImageProcessingApp::renderLoadImageModal() {
@@ -345,6 +519,9 @@ void ImageProcessingApp::renderLoadImageModal() {
         if (!imagePath.empty()) {
             if (processor.loadImage(imagePath)) {
                 std::cout << "Image loaded successfully: " << imagePath << std::endl;
+                viewport.reset();
+                recipe.setSource(processor.getCurrentImage());
+                history.reset(processor.getCurrentImage(), recipe.getSource(), recipe.getSteps(), "Load image");
                 closeModal();
             } else {
                 std::cout << "Failed to load image: " << imagePath << std::endl;
@@ -372,6 +549,7 @@ void ImageProcessingApp::renderConvertGrayscaleModal() {
 
     if (cvui::button(frame, modalWindowX + 20, modalWindowY + 80, 80, 30, "Convert", 0.35)) {
         processor.convertToGrayscale();
+        recordStep(PipelineModule::COLOR, (int)ColorFunction::CONVERT_GRAYSCALE, {});
         std::cout << "convertToGrayscale success" << std::endl;
         closeModal();
     }
@@ -396,6 +574,8 @@ void ImageProcessingApp::renderResetImageModal() {
 
     if (cvui::button(frame, modalWindowX + 20, modalWindowY + 80, 80, 30, "Reset", 0.35)) {
         processor.resetToOriginal();
+        recipe.setSource(processor.getCurrentImage());
+        recordHistory("Reset image");
         std::cout << "Image reset to original" << std::endl;
         closeModal();
     }
@@ -418,11 +598,12 @@ void ImageProcessingApp::renderPreProcessingModal() {
 
     // 初始化预览图像（如果还没有预览图像）
     if (previewImage.empty() && processor.hasImage()) {
-        previewImage = processor.getCurrentImage().clone();
+        previewImage = previewSourceImage();
+        previewRegion = cv::Rect();
     }
 
     // 预览区域
-    UIComponents::renderPreviewArea(frame, modalWindowX + 20, modalWindowY + 40, previewAreaWidth, previewAreaHeight, previewImage);
+    renderPreview();
 
     // 控制区域
     if (currentPreProcessingFunction == PreProcessingFunction::NONE) {
@@ -436,8 +617,6 @@ void ImageProcessingApp::renderPreProcessingModal() {
                 case PreProcessingFunction::ADJUST_CONTRAST:
                     brightness = 0.0;
                     contrast = 1.0;
-                    prevBrightness = brightness - 1;
-                    prevContrast = contrast - 1;
                     break;
                 case PreProcessingFunction::HISTOGRAM_EQUALIZATION:
                     histogramMethod = 0;
@@ -445,26 +624,30 @@ void ImageProcessingApp::renderPreProcessingModal() {
                     break;
                 case PreProcessingFunction::FLATTEN_BACKGROUND:
                     flattenKernelSize = 15;
-                    prevFlattenKernelSize = flattenKernelSize - 2;
+                    break;
+                case PreProcessingFunction::FFT_FILTER:
+                    fftMaskType = 0;
+                    fftCutoff = 0.16;
+                    fftUpperCutoff = 0.5;
+                    fftNotchX = 0.5;
+                    fftNotchY = 0.0;
                     break;
                 default:
                     break;
             }
-
-            updatePreProcessingPreview(currentPreProcessingFunction);
         }
     } else {
         // 参数控制界面
         int result = UIComponents::renderPreProcessingParameters(frame, controlAreaX, controlAreaY, currentPreProcessingFunction,
                                                                brightness, contrast, histogramMethod, clipLimit, flattenKernelSize,
-                                                               prevBrightness, prevContrast, prevClipLimit, prevFlattenKernelSize);
+                                                               fftMaskType, fftCutoff, fftUpperCutoff, fftNotchX, fftNotchY);
 
         if (result == 1) {
             // Back button clicked
             currentPreProcessingFunction = PreProcessingFunction::NONE;
         } else if (result == 2) {
             // Update preview
-            updatePreProcessingPreview(currentPreProcessingFunction);
+            previewTracker.requestUpdate();
         }
     }
 
@@ -473,16 +656,21 @@ void ImageProcessingApp::renderPreProcessingModal() {
 }
 
 void ImageProcessingApp::renderModalButtons(int x, int y) {
+    if (editingStepIndex >= 0) {
+        cvui::text(frame, x, y - 25, ("Editing recipe step " + std::to_string(editingStepIndex + 1)).c_str(), 0.35);
+    }
+    renderTimingInfo(modalWindowX + 20, modalWindowY + modalWindowHeight - 60);
+
     int result = UIComponents::renderModalButtons(frame, x, y);
 
     if (result == 1) {
         // Apply button clicked
-        std::cout << "DEBUG: Apply button clicked! currentModal = " << (int)currentModal
-                  << ", currentPreProcessingFunction = " << (int)currentPreProcessingFunction << std::endl;
+        LOG_DEBUG("Apply button clicked! currentModal = " << (int)currentModal
+                  << ", currentPreProcessingFunction = " << (int)currentPreProcessingFunction);
         applyCurrentFunction();
-        std::cout << "DEBUG: applyCurrentFunction() completed, closing modal" << std::endl;
+        LOG_DEBUG("applyCurrentFunction() completed, closing modal");
         closeModal();
-        std::cout << "DEBUG: Modal closed" << std::endl;
+        LOG_DEBUG("Modal closed");
     } else if (result == 2) {
         // Cancel button clicked
         closeModal();
@@ -490,54 +678,69 @@ void ImageProcessingApp::renderModalButtons(int x, int y) {
 }
 
 void ImageProcessingApp::applyCurrentFunction() {
+    ScopedTimer timer("Apply " + Pipeline::timerName(buildCurrentStep()));
+
+    if (editingStepIndex >= 0) {
+        applyEditedStep();
+        return;
+    }
+
     switch (currentModal) {
         case ModalFunction::PRE_PROCESSING:
-            std::cout << "DEBUG: PRE_PROCESSING case reached, currentPreProcessingFunction = " << (int)currentPreProcessingFunction << std::endl;
+            LOG_DEBUG("PRE_PROCESSING case reached, currentPreProcessingFunction = " << (int)currentPreProcessingFunction);
             if (currentPreProcessingFunction != PreProcessingFunction::NONE) {
-                std::cout << "DEBUG: Applying pre-processing function using direct ImageProcessor methods..." << std::endl;
+                LOG_DEBUG("Applying pre-processing function using direct ImageProcessor methods...");
 
                 // 直接调用ImageProcessor的方法，模仿其他工作功能的模式
                 switch (currentPreProcessingFunction) {
                     case PreProcessingFunction::ADJUST_CONTRAST:
                         processor.adjustContrast(brightness, contrast);
+                        recordStep(PipelineModule::PRE_PROCESSING, (int)currentPreProcessingFunction, {brightness, contrast});
                         std::cout << "Applied contrast adjustment via ImageProcessor: brightness=" << brightness << ", contrast=" << contrast << std::endl;
                         break;
                     case PreProcessingFunction::HISTOGRAM_EQUALIZATION:
                         processor.applyHistogramEqualization(histogramMethod, clipLimit);
+                        recordStep(PipelineModule::PRE_PROCESSING, (int)currentPreProcessingFunction, {(double)histogramMethod, clipLimit});
                         std::cout << "Applied histogram equalization via ImageProcessor: method=" << (histogramMethod == 0 ? "global" : "adaptive")
                                   << (histogramMethod == 1 ? ", clip limit=" + std::to_string(clipLimit) : "") << std::endl;
                         break;
                     case PreProcessingFunction::FLATTEN_BACKGROUND:
                         processor.flattenBackground(flattenKernelSize);
+                        recordStep(PipelineModule::PRE_PROCESSING, (int)currentPreProcessingFunction, {(double)flattenKernelSize});
                         std::cout << "Applied background flattening via ImageProcessor with kernel size=" << flattenKernelSize << std::endl;
                         break;
                     default:
-                        std::cout << "DEBUG: Using fallback method for function " << (int)currentPreProcessingFunction << std::endl;
+                        LOG_DEBUG("Using fallback method for function " << (int)currentPreProcessingFunction);
                         applyPreProcessingFunction(currentPreProcessingFunction);
                         break;
                 }
 
-                std::cout << "DEBUG: Pre-processing function applied successfully" << std::endl;
+                LOG_DEBUG("Pre-processing function applied successfully");
             } else {
-                std::cout << "DEBUG: currentPreProcessingFunction is NONE, skipping application" << std::endl;
+                LOG_DEBUG("currentPreProcessingFunction is NONE, skipping application");
             }
             break;
         case ModalFunction::COLOR_SELECT:
             processor.colorSelect(hue_min, hue_max, sat_min, sat_max, val_min, val_max);
+            recordStep(PipelineModule::COLOR, (int)ColorFunction::COLOR_SELECT,
+                       {(double)hue_min, (double)hue_max, (double)sat_min, (double)sat_max, (double)val_min, (double)val_max});
             std::cout << "Applied color selection with HSV ranges" << std::endl;
             break;
         case ModalFunction::COLOR_CLUSTER:
             processor.colorCluster(k_clusters);
+            recordStep(PipelineModule::COLOR, (int)ColorFunction::COLOR_CLUSTER, {(double)k_clusters});
             std::cout << "Applied color clustering with k=" << k_clusters << std::endl;
             break;
         case ModalFunction::COLOR_DECONVOLUTION:
             processor.colorDeconvolution(deconvolution_channel);
+            recordStep(PipelineModule::COLOR, (int)ColorFunction::COLOR_DECONVOLUTION, {(double)deconvolution_channel});
             std::cout << "Applied color deconvolution on channel " << deconvolution_channel << std::endl;
             break;
         case ModalFunction::CHANNEL_OPERATION:
             {
                 const char* operations[] = {"add", "subtract", "multiply", "divide"};
                 processor.channelOperation(operations[operation_type], operation_value);
+                recordStep(PipelineModule::COLOR, (int)ColorFunction::CHANNEL_OPERATION, {(double)operation_type, operation_value});
                 std::cout << "Applied channel operation: " << operations[operation_type] << " " << operation_value << std::endl;
             }
             break;
@@ -599,6 +802,16 @@ void ImageProcessingApp::applyPreProcessingFunction(PreProcessingFunction functi
                 result = PreProcessing::applyFunction(currentImage, function, params);
                 std::cout << "Applied background flattening with kernel size=" << flattenKernelSize << std::endl;
                 break;
+            case PreProcessingFunction::SUM_FILTER:
+                params = kSumFilterParams;
+                result = PreProcessing::applyFunction(currentImage, function, params);
+                std::cout << "Applied sum filter with kernel size=" << params[0] << std::endl;
+                break;
+            case PreProcessingFunction::FFT_FILTER:
+                params = {(double)fftMaskType, fftCutoff, fftUpperCutoff, fftNotchX, fftNotchY};
+                result = PreProcessing::applyFunction(currentImage, function, params);
+                std::cout << "Applied FFT filter: mask=" << fftMaskType << ", cutoff=" << fftCutoff << std::endl;
+                break;
             default:
                 // 对于其他功能，使用默认参数
                 result = PreProcessing::applyFunction(currentImage, function, {});
@@ -607,12 +820,14 @@ void ImageProcessingApp::applyPreProcessingFunction(PreProcessingFunction functi
         }
 
         if (!result.empty()) {
-            std::cout << "DEBUG: Processing result - empty: " << result.empty()
+            LOG_DEBUG("Processing result - empty: " << result.empty()
                       << ", size: " << result.cols << "x" << result.rows
-                      << ", channels: " << result.channels() << std::endl;
+                      << ", channels: " << result.channels());
 
             // 更新处理器中的图像 - 使用新的专用方法
-            processor.applyPreProcessedImage(result);
+            processor.applyPreProcessedImage(std::move(result));
+            recordStep(PipelineModule::PRE_PROCESSING, (int)function, params);
+            fftPreviewCache.clear();
         }
 
     } catch (const std::exception& e) {
@@ -625,38 +840,43 @@ void ImageProcessingApp::updatePreProcessingPreview(PreProcessingFunction functi
         return;
     }
 
-    cv::Mat tempImage = processor.getCurrentImage().clone();
+    // 准备参数数组
+    std::vector<double> params;
 
-    try {
-        // 准备参数数组
-        std::vector<double> params;
-
-        switch (function) {
-            case PreProcessingFunction::ADJUST_CONTRAST:
-                params = {brightness, contrast};
-                tempImage = PreProcessing::applyFunction(tempImage, function, params);
-                break;
-            case PreProcessingFunction::HISTOGRAM_EQUALIZATION:
-                params = {(double)histogramMethod, clipLimit};
-                tempImage = PreProcessing::applyFunction(tempImage, function, params);
-                break;
-            case PreProcessingFunction::FLATTEN_BACKGROUND:
-                params = {(double)flattenKernelSize};
-                tempImage = PreProcessing::applyFunction(tempImage, function, params);
-                break;
-            default:
-                // 对于其他功能，使用默认参数
-                tempImage = PreProcessing::applyFunction(tempImage, function, {});
-                break;
-        }
+    switch (function) {
+        case PreProcessingFunction::ADJUST_CONTRAST:
+            params = {brightness, contrast};
+            break;
+        case PreProcessingFunction::HISTOGRAM_EQUALIZATION:
+            params = {(double)histogramMethod, clipLimit};
+            break;
+        case PreProcessingFunction::FLATTEN_BACKGROUND:
+            params = {(double)flattenKernelSize};
+            break;
+        case PreProcessingFunction::SUM_FILTER:
+            params = kSumFilterParams;
+            break;
+        case PreProcessingFunction::FFT_FILTER:
+            params = {(double)fftMaskType, fftCutoff, fftUpperCutoff, fftNotchX, fftNotchY};
+            break;
+        default:
+            // 对于其他功能，使用默认参数
+            break;
+    }
 
-        if (!tempImage.empty()) {
-            previewImage = tempImage.clone();
+    FrequencyFilter* fftCache = &fftPreviewCache;
+    submitPreview([function, params, fftCache](const cv::Mat& source, double scale) {
+        PipelineStep step = ProxyPyramid::scaleStep(PipelineStep(PipelineModule::PRE_PROCESSING, (int)function, params), scale);
+        PreviewResult result;
+        if (function == PreProcessingFunction::FFT_FILTER) {
+            // 调整掩模时输入是同一张代理图像，复用缓存的正向频谱
+            const std::vector<double>& p = step.params;
+            result.image = PreProcessing::fftFilter(source, (int)p[0], p[1], p[2], p[3], p[4], fftCache);
+        } else {
+            result.image = PreProcessing::applyFunction(source, function, step.params);
         }
-
-    } catch (const std::exception& e) {
-        std::cout << "Error updating pre-processing preview: " << e.what() << std::endl;
-    }
+        return result;
+    });
 }
 
 // Color processing preview methods
@@ -665,16 +885,17 @@ void ImageProcessingApp::updateColorSelectPreview() {
         return;
     }
 
-    cv::Mat tempImage = processor.getCurrentImage().clone();
-    cv::Mat hsv, mask, result;
-    cv::cvtColor(tempImage, hsv, cv::COLOR_BGR2HSV);
-
     cv::Scalar lower(hue_min, sat_min, val_min);
     cv::Scalar upper(hue_max, sat_max, val_max);
-    cv::inRange(hsv, lower, upper, mask);
-
-    tempImage.copyTo(result, mask);
-    previewImage = result.clone();
+    submitPreview([lower, upper](const cv::Mat& source, double) {
+        cv::Mat hsv, mask;
+        cv::cvtColor(source, hsv, cv::COLOR_BGR2HSV);
+        cv::inRange(hsv, lower, upper, mask);
+
+        PreviewResult result;
+        source.copyTo(result.image, mask);
+        return result;
+    });
 }
 
 void ImageProcessingApp::updateColorClusterPreview() {
@@ -682,8 +903,12 @@ void ImageProcessingApp::updateColorClusterPreview() {
         return;
     }
 
-    cv::Mat tempImage = processor.getCurrentImage().clone();
-    previewImage = processor.performKMeans(tempImage, k_clusters);
+    int k = k_clusters;
+    submitPreview([k](const cv::Mat& source, double) {
+        PreviewResult result;
+        result.image = ColorProcessing::performKMeans(source, k);
+        return result;
+    });
 }
 
 void ImageProcessingApp::updateColorDeconvolutionPreview() {
@@ -691,15 +916,17 @@ void ImageProcessingApp::updateColorDeconvolutionPreview() {
         return;
     }
 
-    cv::Mat tempImage = processor.getCurrentImage().clone();
-    std::vector<cv::Mat> channels;
-    cv::split(tempImage, channels);
+    int channel = deconvolution_channel;
+    submitPreview([channel](const cv::Mat& source, double) {
+        PreviewResult result;
+        std::vector<cv::Mat> channels;
+        cv::split(source, channels);
 
-    if (deconvolution_channel >= 0 && deconvolution_channel < channels.size()) {
-        cv::Mat result;
-        cv::cvtColor(channels[deconvolution_channel], result, cv::COLOR_GRAY2BGR);
-        previewImage = result.clone();
-    }
+        if (channel >= 0 && channel < (int)channels.size()) {
+            cv::cvtColor(channels[channel], result.image, cv::COLOR_GRAY2BGR);
+        }
+        return result;
+    });
 }
 
 void ImageProcessingApp::updateChannelOperationPreview() {
@@ -707,22 +934,30 @@ void ImageProcessingApp::updateChannelOperationPreview() {
         return;
     }
 
-    cv::Mat tempImage = processor.getCurrentImage().clone();
-    cv::Mat result;
+    if (operation_type < 0 || operation_type >= 4) {
+        return;
+    }
 
-    const char* operations[] = {"add", "subtract", "multiply", "divide"};
-    if (operation_type >= 0 && operation_type < 4) {
-        if (operations[operation_type] == std::string("add")) {
-            cv::add(tempImage, cv::Scalar::all(operation_value), result);
-        } else if (operations[operation_type] == std::string("subtract")) {
-            cv::subtract(tempImage, cv::Scalar::all(operation_value), result);
-        } else if (operations[operation_type] == std::string("multiply")) {
-            cv::multiply(tempImage, cv::Scalar::all(operation_value), result);
-        } else if (operations[operation_type] == std::string("divide")) {
-            cv::divide(tempImage, cv::Scalar::all(operation_value), result);
+    int operation = operation_type;
+    double value = operation_value;
+    submitPreview([operation, value](const cv::Mat& source, double) {
+        PreviewResult result;
+        switch (operation) {
+            case 0:
+                cv::add(source, cv::Scalar::all(value), result.image);
+                break;
+            case 1:
+                cv::subtract(source, cv::Scalar::all(value), result.image);
+                break;
+            case 2:
+                cv::multiply(source, cv::Scalar::all(value), result.image);
+                break;
+            default:
+                cv::divide(source, cv::Scalar::all(value), result.image);
+                break;
         }
-        previewImage = result.clone();
-    }
+        return result;
+    });
 }
 
 // Segmentation methods
@@ -761,7 +996,8 @@ void ImageProcessingApp::applySegmentationFunction(SegmentationFunction function
         }
 
         if (!result.empty()) {
-            processor.setCurrentImage(result);
+            processor.setCurrentImage(std::move(result));
+            recordStep(PipelineModule::SEGMENTATION, (int)function, params);
         }
 
     } catch (const std::exception& e) {
@@ -774,36 +1010,28 @@ void ImageProcessingApp::updateSegmentationPreview(SegmentationFunction function
         return;
     }
 
-    cv::Mat tempImage = processor.getCurrentImage().clone();
+    std::vector<double> params;
 
-    try {
-        std::vector<double> params;
-
-        switch (function) {
-            case SegmentationFunction::BASIC_THRESHOLD:
-                params = {thresholdValue, (double)thresholdType};
-                tempImage = Segmentation::applyFunction(tempImage, function, params);
-                break;
-            case SegmentationFunction::RANGE_THRESHOLD:
-                params = {thresholdMin, thresholdMax};
-                tempImage = Segmentation::applyFunction(tempImage, function, params);
-                break;
-            case SegmentationFunction::ADAPTIVE_THRESHOLD:
-                params = {(double)adaptiveMethod, (double)thresholdType, (double)blockSize, C};
-                tempImage = Segmentation::applyFunction(tempImage, function, params);
-                break;
-            default:
-                tempImage = Segmentation::applyFunction(tempImage, function, {});
-                break;
-        }
-
-        if (!tempImage.empty()) {
-            previewImage = tempImage.clone();
-        }
-
-    } catch (const std::exception& e) {
-        std::cout << "Error updating segmentation preview: " << e.what() << std::endl;
+    switch (function) {
+        case SegmentationFunction::BASIC_THRESHOLD:
+            params = {thresholdValue, (double)thresholdType};
+            break;
+        case SegmentationFunction::RANGE_THRESHOLD:
+            params = {thresholdMin, thresholdMax};
+            break;
+        case SegmentationFunction::ADAPTIVE_THRESHOLD:
+            params = {(double)adaptiveMethod, (double)thresholdType, (double)blockSize, C};
+            break;
+        default:
+            break;
     }
+
+    submitPreview([function, params](const cv::Mat& source, double scale) {
+        PipelineStep step = ProxyPyramid::scaleStep(PipelineStep(PipelineModule::SEGMENTATION, (int)function, params), scale);
+        PreviewResult result;
+        result.image = Segmentation::applyFunction(source, function, step.params);
+        return result;
+    });
 }
 
 // Morphology methods
@@ -827,7 +1055,8 @@ void ImageProcessingApp::applyMorphologyFunction(MorphologyFunction function) {
         std::cout << std::endl;
 
         if (!result.empty()) {
-            processor.setCurrentImage(result);
+            processor.setCurrentImage(std::move(result));
+            recordStep(PipelineModule::MORPHOLOGY, (int)function, params);
         }
 
     } catch (const std::exception& e) {
@@ -840,19 +1069,13 @@ void ImageProcessingApp::updateMorphologyPreview(MorphologyFunction function) {
         return;
     }
 
-    cv::Mat tempImage = processor.getCurrentImage().clone();
-
-    try {
-        std::vector<double> params = {(double)morphKernelSize, (double)morphKernelType, edgeThreshold, (double)separationMethod};
-        tempImage = Morphology::applyFunction(tempImage, function, params);
-
-        if (!tempImage.empty()) {
-            previewImage = tempImage.clone();
-        }
-
-    } catch (const std::exception& e) {
-        std::cout << "Error updating morphology preview: " << e.what() << std::endl;
-    }
+    std::vector<double> params = {(double)morphKernelSize, (double)morphKernelType, edgeThreshold, (double)separationMethod};
+    submitPreview([function, params](const cv::Mat& source, double scale) {
+        PipelineStep step = ProxyPyramid::scaleStep(PipelineStep(PipelineModule::MORPHOLOGY, (int)function, params), scale);
+        PreviewResult result;
+        result.image = Morphology::applyFunction(source, function, step.params);
+        return result;
+    });
 }
 
 // CleanUp methods
@@ -886,7 +1109,8 @@ void ImageProcessingApp::applyCleanUpFunction(CleanUpFunction function) {
         }
 
         if (!result.empty()) {
-            processor.setCurrentImage(result);
+            processor.setCurrentImage(std::move(result));
+            recordStep(PipelineModule::CLEAN_UP, (int)function, params);
         }
 
     } catch (const std::exception& e) {
@@ -899,36 +1123,29 @@ void ImageProcessingApp::updateCleanUpPreview(CleanUpFunction function) {
         return;
     }
 
-    cv::Mat tempImage = processor.getCurrentImage().clone();
-
-    try {
-        std::vector<double> params;
-
-        switch (function) {
-            case CleanUpFunction::FILL_ALL_HOLES:
-                params = {(double)minHoleSize, (double)fillMethod};
-                tempImage = CleanUp::applyFunction(tempImage, function, params);
-                break;
-            case CleanUpFunction::REJECT_FEATURES:
-                params = {(double)minFeatureSize, (double)maxFeatureSize, (double)rejectMethod};
-                tempImage = CleanUp::applyFunction(tempImage, function, params);
-                break;
-            default:
-                tempImage = CleanUp::applyFunction(tempImage, function, {});
-                break;
-        }
-
-        if (!tempImage.empty()) {
-            previewImage = tempImage.clone();
-        }
+    std::vector<double> params;
 
-    } catch (const std::exception& e) {
-        std::cout << "Error updating clean-up preview: " << e.what() << std::endl;
+    switch (function) {
+        case CleanUpFunction::FILL_ALL_HOLES:
+            params = {(double)minHoleSize, (double)fillMethod};
+            break;
+        case CleanUpFunction::REJECT_FEATURES:
+            params = {(double)minFeatureSize, (double)maxFeatureSize, (double)rejectMethod};
+            break;
+        default:
+            break;
     }
+
+    submitPreview([function, params](const cv::Mat& source, double scale) {
+        PipelineStep step = ProxyPyramid::scaleStep(PipelineStep(PipelineModule::CLEAN_UP, (int)function, params), scale);
+        PreviewResult result;
+        result.image = CleanUp::applyFunction(source, function, step.params);
+        return result;
+    });
 }
 
 #ifdef _WIN32
-std::string ImageProcessingApp::openFileDialog() {
+std::string ImageProcessingApp::openFileDialog(const char* filter) {
     OPENFILENAME ofn;
     char szFile[260] = {0};
 
@@ -936,7 +1153,7 @@ std::string ImageProcessingApp::openFileDialog() {
     ofn.lStructSize = sizeof(ofn);
     ofn.lpstrFile = szFile;
     ofn.nMaxFile = sizeof(szFile);
-    ofn.lpstrFilter = "Image Files\0*.jpg;*.jpeg;*.png;*.bmp;*.tiff;*.tif\0All Files\0*.*\0";
+    ofn.lpstrFilter = filter ? filter : "Image Files\0*.jpg;*.jpeg;*.png;*.bmp;*.tiff;*.tif\0All Files\0*.*\0";
     ofn.nFilterIndex = 1;
     ofn.lpstrFileTitle = NULL;
     ofn.nMaxFileTitle = 0;
@@ -949,8 +1166,33 @@ std::string ImageProcessingApp::openFileDialog() {
 
     return "";
 }
+
+std::string ImageProcessingApp::saveFileDialog(const char* filter, const char* defaultExtension) {
+    OPENFILENAME ofn;
+    char szFile[260] = {0};
+
+    ZeroMemory(&ofn, sizeof(ofn));
+    ofn.lStructSize = sizeof(ofn);
+    ofn.lpstrFile = szFile;
+    ofn.nMaxFile = sizeof(szFile);
+    ofn.lpstrFilter = filter;
+    ofn.nFilterIndex = 1;
+    ofn.lpstrDefExt = defaultExtension;
+    ofn.Flags = OFN_PATHMUSTEXIST | OFN_OVERWRITEPROMPT;
+
+    if (GetSaveFileName(&ofn)) {
+        return std::string(szFile);
+    }
+
+    return "";
+}
 #else
-std::string ImageProcessingApp::openFileDialog() {
+std::string ImageProcessingApp::openFileDialog(const char* filter) {
+    // Linux/Mac implementation would go here
+    return "";
+}
+
+std::string ImageProcessingApp::saveFileDialog(const char* filter, const char* defaultExtension) {
     // Linux/Mac implementation would go here
     return "";
 }
@@ -970,11 +1212,12 @@ void ImageProcessingApp::renderColorSelectModal() {
 
     // 初始化预览图像（如果还没有预览图像）
     if (previewImage.empty() && processor.hasImage()) {
-        previewImage = processor.getCurrentImage().clone();
+        previewImage = previewSourceImage();
+        previewRegion = cv::Rect();
     }
 
     // 预览区域
-    UIComponents::renderPreviewArea(frame, modalWindowX + 20, modalWindowY + 40, previewAreaWidth, previewAreaHeight, previewImage);
+    renderPreview();
 
     // 控制区域
     int currentY = controlAreaY;
@@ -985,11 +1228,6 @@ void ImageProcessingApp::renderColorSelectModal() {
     // Hue range
     cvui::text(frame, controlAreaX, currentY, "Hue Range:", 0.35);
     currentY += 20;
-    // 保存之前的值用于变化检测
-    static int prev_hue_min = hue_min, prev_hue_max = hue_max;
-    static int prev_sat_min = sat_min, prev_sat_max = sat_max;
-    static int prev_val_min = val_min, prev_val_max = val_max;
-
     cvui::trackbar(frame, controlAreaX, currentY, 180, &hue_min, 0, 179);
     cvui::text(frame, controlAreaX + 190, currentY + 8, ("Min: " + std::to_string(hue_min)).c_str(), 0.3);
     currentY += 30;
@@ -1017,18 +1255,8 @@ void ImageProcessingApp::renderColorSelectModal() {
     cvui::text(frame, controlAreaX + 190, currentY + 8, ("Max: " + std::to_string(val_max)).c_str(), 0.3);
     currentY += 40;
 
-    // 检测参数变化并自动更新预览
-    if (hue_min != prev_hue_min || hue_max != prev_hue_max ||
-        sat_min != prev_sat_min || sat_max != prev_sat_max ||
-        val_min != prev_val_min || val_max != prev_val_max) {
-        updateColorSelectPreview();
-        prev_hue_min = hue_min; prev_hue_max = hue_max;
-        prev_sat_min = sat_min; prev_sat_max = sat_max;
-        prev_val_min = val_min; prev_val_max = val_max;
-    }
-
     if (cvui::button(frame, controlAreaX, currentY, 120, 25, "Update Preview", 0.35)) {
-        updateColorSelectPreview();
+        previewTracker.requestUpdate();
     }
 
     // Apply/Cancel按钮
@@ -1048,11 +1276,12 @@ void ImageProcessingApp::renderColorClusterModal() {
 
     // 初始化预览图像（如果还没有预览图像）
     if (previewImage.empty() && processor.hasImage()) {
-        previewImage = processor.getCurrentImage().clone();
+        previewImage = previewSourceImage();
+        previewRegion = cv::Rect();
     }
 
     // 预览区域
-    UIComponents::renderPreviewArea(frame, modalWindowX + 20, modalWindowY + 40, previewAreaWidth, previewAreaHeight, previewImage);
+    renderPreview();
 
     // 控制区域
     int currentY = controlAreaY;
@@ -1063,25 +1292,16 @@ void ImageProcessingApp::renderColorClusterModal() {
     cvui::text(frame, controlAreaX, currentY, "Number of Clusters (K):", 0.35);
     currentY += 20;
 
-    // 保存之前的值用于变化检测
-    static int prev_k_clusters = k_clusters;
-
     cvui::trackbar(frame, controlAreaX, currentY, 200, &k_clusters, 2, 16);
     cvui::text(frame, controlAreaX + 210, currentY + 8, ("K = " + std::to_string(k_clusters)).c_str(), 0.3);
     currentY += 40;
 
-    // 检测参数变化并自动更新预览
-    if (k_clusters != prev_k_clusters) {
-        updateColorClusterPreview();
-        prev_k_clusters = k_clusters;
-    }
-
     cvui::text(frame, controlAreaX, currentY, "Current setting: " + std::to_string(k_clusters) + " clusters", 0.3);
     cvui::text(frame, controlAreaX, currentY + 15, "Higher values = more color detail", 0.25);
     cvui::text(frame, controlAreaX, currentY + 30, "Lower values = more color reduction", 0.25);
 
     if (cvui::button(frame, controlAreaX, currentY + 60, 120, 25, "Update Preview", 0.35)) {
-        updateColorClusterPreview();
+        previewTracker.requestUpdate();
     }
 
     // Apply/Cancel按钮
@@ -1100,7 +1320,7 @@ void ImageProcessingApp::renderColorDeconvolutionModal() {
     }
 
     // 预览区域
-    UIComponents::renderPreviewArea(frame, modalWindowX + 20, modalWindowY + 40, previewAreaWidth, previewAreaHeight, previewImage);
+    renderPreview();
 
     // 控制区域
     int currentY = controlAreaY;
@@ -1113,7 +1333,7 @@ void ImageProcessingApp::renderColorDeconvolutionModal() {
 
     if (cvui::button(frame, controlAreaX, currentY, 100, 25, "Blue Channel", 0.3)) {
         deconvolution_channel = 0;
-        updateColorDeconvolutionPreview();
+        previewTracker.requestUpdate();
     }
     if (deconvolution_channel == 0) {
         cvui::text(frame, controlAreaX + 110, currentY + 8, "<- Selected", 0.25);
@@ -1122,7 +1342,7 @@ void ImageProcessingApp::renderColorDeconvolutionModal() {
 
     if (cvui::button(frame, controlAreaX, currentY, 100, 25, "Green Channel", 0.3)) {
         deconvolution_channel = 1;
-        updateColorDeconvolutionPreview();
+        previewTracker.requestUpdate();
     }
     if (deconvolution_channel == 1) {
         cvui::text(frame, controlAreaX + 110, currentY + 8, "<- Selected", 0.25);
@@ -1131,7 +1351,7 @@ void ImageProcessingApp::renderColorDeconvolutionModal() {
 
     if (cvui::button(frame, controlAreaX, currentY, 100, 25, "Red Channel", 0.3)) {
         deconvolution_channel = 2;
-        updateColorDeconvolutionPreview();
+        previewTracker.requestUpdate();
     }
     if (deconvolution_channel == 2) {
         cvui::text(frame, controlAreaX + 110, currentY + 8, "<- Selected", 0.25);
@@ -1157,7 +1377,7 @@ void ImageProcessingApp::renderChannelOperationModal() {
     }
 
     // 预览区域
-    UIComponents::renderPreviewArea(frame, modalWindowX + 20, modalWindowY + 40, previewAreaWidth, previewAreaHeight, previewImage);
+    renderPreview();
 
     // 控制区域
     int currentY = controlAreaY;
@@ -1172,7 +1392,7 @@ void ImageProcessingApp::renderChannelOperationModal() {
     for (int i = 0; i < 4; i++) {
         if (cvui::button(frame, controlAreaX + (i % 2) * 110, currentY + (i / 2) * 30, 100, 25, operations[i], 0.3)) {
             operation_type = i;
-            updateChannelOperationPreview();
+            previewTracker.requestUpdate();
         }
         if (operation_type == i) {
             cvui::text(frame, controlAreaX + (i % 2) * 110 + 105, currentY + (i / 2) * 30 + 8, "<-", 0.25);
@@ -1189,7 +1409,7 @@ void ImageProcessingApp::renderChannelOperationModal() {
     cvui::text(frame, controlAreaX, currentY, ("Current: " + std::string(operations[operation_type]) + " " + std::to_string(operation_value).substr(0, 4)).c_str(), 0.3);
 
     if (cvui::button(frame, controlAreaX, currentY + 30, 120, 25, "Update Preview", 0.35)) {
-        updateChannelOperationPreview();
+        previewTracker.requestUpdate();
     }
 
     // Apply/Cancel按钮
@@ -1209,11 +1429,12 @@ void ImageProcessingApp::renderSegmentationModal() {
 
     // 初始化预览图像（如果还没有预览图像）
     if (previewImage.empty() && processor.hasImage()) {
-        previewImage = processor.getCurrentImage().clone();
+        previewImage = previewSourceImage();
+        previewRegion = cv::Rect();
     }
 
     // 预览区域
-    UIComponents::renderPreviewArea(frame, modalWindowX + 20, modalWindowY + 40, previewAreaWidth, previewAreaHeight, previewImage);
+    renderPreview();
 
     // 控制区域
     if (currentSegmentationFunction == SegmentationFunction::NONE) {
@@ -1241,8 +1462,6 @@ void ImageProcessingApp::renderSegmentationModal() {
                 default:
                     break;
             }
-
-            updateSegmentationPreview(currentSegmentationFunction);
         }
     } else {
         // 参数控制界面
@@ -1255,8 +1474,9 @@ void ImageProcessingApp::renderSegmentationModal() {
             currentSegmentationFunction = SegmentationFunction::NONE;
         } else if (result == 2) {
             // Update preview
-            updateSegmentationPreview(currentSegmentationFunction);
+            previewTracker.requestUpdate();
         }
+        renderSweepButton(controlAreaX + 200, modalWindowY + modalWindowHeight - 70);
     }
 
     // Apply/Cancel按钮
@@ -1276,11 +1496,12 @@ void ImageProcessingApp::renderMorphologyModal() {
 
     // 初始化预览图像（如果还没有预览图像）
     if (previewImage.empty() && processor.hasImage()) {
-        previewImage = processor.getCurrentImage().clone();
+        previewImage = previewSourceImage();
+        previewRegion = cv::Rect();
     }
 
     // 预览区域
-    UIComponents::renderPreviewArea(frame, modalWindowX + 20, modalWindowY + 40, previewAreaWidth, previewAreaHeight, previewImage);
+    renderPreview();
 
     // 控制区域
     if (currentMorphologyFunction == MorphologyFunction::NONE) {
@@ -1294,8 +1515,6 @@ void ImageProcessingApp::renderMorphologyModal() {
             morphKernelType = 1; // ELLIPSE
             edgeThreshold = 100.0;
             separationMethod = 0; // Canny
-
-            updateMorphologyPreview(currentMorphologyFunction);
         }
     } else {
         // 参数控制界面
@@ -1307,8 +1526,9 @@ void ImageProcessingApp::renderMorphologyModal() {
             currentMorphologyFunction = MorphologyFunction::NONE;
         } else if (result == 2) {
             // Update preview
-            updateMorphologyPreview(currentMorphologyFunction);
+            previewTracker.requestUpdate();
         }
+        renderSweepButton(controlAreaX + 200, modalWindowY + modalWindowHeight - 70);
     }
 
     // Apply/Cancel按钮
@@ -1328,11 +1548,12 @@ void ImageProcessingApp::renderCleanUpModal() {
 
     // 初始化预览图像（如果还没有预览图像）
     if (previewImage.empty() && processor.hasImage()) {
-        previewImage = processor.getCurrentImage().clone();
+        previewImage = previewSourceImage();
+        previewRegion = cv::Rect();
     }
 
     // 预览区域
-    UIComponents::renderPreviewArea(frame, modalWindowX + 20, modalWindowY + 40, previewAreaWidth, previewAreaHeight, previewImage);
+    renderPreview();
 
     // 控制区域
     if (currentCleanUpFunction == CleanUpFunction::NONE) {
@@ -1355,8 +1576,6 @@ void ImageProcessingApp::renderCleanUpModal() {
                 default:
                     break;
             }
-
-            updateCleanUpPreview(currentCleanUpFunction);
         }
     } else {
         // 参数控制界面
@@ -1368,7 +1587,7 @@ void ImageProcessingApp::renderCleanUpModal() {
             currentCleanUpFunction = CleanUpFunction::NONE;
         } else if (result == 2) {
             // Update preview
-            updateCleanUpPreview(currentCleanUpFunction);
+            previewTracker.requestUpdate();
         }
     }
 
@@ -1389,11 +1608,12 @@ void ImageProcessingApp::renderMeasurementsModal() {
 
     // 初始化预览图像（如果还没有预览图像）
     if (previewImage.empty() && processor.hasImage()) {
-        previewImage = processor.getCurrentImage().clone();
+        previewImage = previewSourceImage();
+        previewRegion = cv::Rect();
     }
 
     // 预览区域
-    UIComponents::renderPreviewArea(frame, modalWindowX + 20, modalWindowY + 40, previewAreaWidth, previewAreaHeight, previewImage);
+    renderPreview();
 
     // 控制区域
     if (currentMeasurementsFunction == MeasurementsFunction::NONE) {
@@ -1412,8 +1632,6 @@ void ImageProcessingApp::renderMeasurementsModal() {
                 default:
                     break;
             }
-
-            updateMeasurementsPreview(currentMeasurementsFunction);
         }
     } else {
         // 参数控制界面
@@ -1425,7 +1643,7 @@ void ImageProcessingApp::renderMeasurementsModal() {
             currentMeasurementsFunction = MeasurementsFunction::NONE;
         } else if (result == 2) {
             // Update preview
-            updateMeasurementsPreview(currentMeasurementsFunction);
+            previewTracker.requestUpdate();
         }
     }
 
@@ -1463,7 +1681,8 @@ void ImageProcessingApp::applyMeasurementsFunction(MeasurementsFunction function
         // Create visualization image and set it as current image
         cv::Mat visualizationImage = Measurements::createVisualizationImage(currentImage, lastMeasurementResult, minObjectSize, maxObjectSize);
         if (!visualizationImage.empty()) {
-            processor.setCurrentImage(visualizationImage);
+            processor.setCurrentImage(std::move(visualizationImage));
+            recordStep(PipelineModule::MEASUREMENTS, (int)function, params);
         }
 
     } catch (const std::exception& e) {
@@ -1476,21 +1695,757 @@ void ImageProcessingApp::updateMeasurementsPreview(MeasurementsFunction function
         return;
     }
 
-    cv::Mat tempImage = processor.getCurrentImage().clone();
-
-    try {
-        std::vector<double> params = {(double)minObjectSize, (double)maxObjectSize, sensitivity};
-        MeasurementResult result = Measurements::applyFunction(tempImage, function, params);
+    std::vector<double> params = {(double)minObjectSize, (double)maxObjectSize, sensitivity};
+    submitPreview([function, params](const cv::Mat& source, double scale) {
+        PipelineStep step = ProxyPyramid::scaleStep(PipelineStep(PipelineModule::MEASUREMENTS, (int)function, params), scale);
+        PreviewResult result;
+        MeasurementResult measurement = Measurements::applyFunction(source, function, step.params);
 
         // Create visualization for preview
-        cv::Mat visualizationImage = Measurements::createVisualizationImage(tempImage, result, minObjectSize, maxObjectSize);
+        result.image = Measurements::createVisualizationImage(source, measurement, (int)step.params[0], (int)step.params[1]);
+        result.measurement = ProxyPyramid::unscaleMeasurement(measurement, scale);
+        result.hasMeasurement = true;
+        return result;
+    });
+}
 
-        if (!visualizationImage.empty()) {
-            previewImage = visualizationImage.clone();
-            lastMeasurementResult = result; // Store for display
+void ImageProcessingApp::submitPreview(PreviewCompute compute) {
+    sweepActive = false;
+    previewCompute = compute;
+    previewRefineLevel = nextPreviewLevel(kCoarsePreviewLevel + 1);
+    submitPreviewLevel(previewRefineLevel);
+}
+
+void ImageProcessingApp::submitPreviewLevel(int level) {
+    // 输入图像和计时项名称在界面线程中确定，任务只按值持有它们
+    cv::Mat source = previewSourceImage();
+    std::string timerName = previewTimerName(level);
+    PreviewCompute compute = previewCompute;
+    ProxyPyramid* proxy = &previewProxy;
+    cv::Size displaySize(previewAreaWidth, previewAreaHeight);
+    cv::Size levelSize(std::max(1, displaySize.width >> level), std::max(1, displaySize.height >> level));
+
+    submittedPreviewView = viewport.isZoomed() ? viewport.visibleRect(source.size(), previewViewSize()) : cv::Rect();
+    if (viewport.isZoomed()) {
+        cv::Rect visible = submittedPreviewView;
+        double viewScale = std::ldexp(viewport.pixelScale(source.size(), previewViewSize()), -level);
+        PipelineStep step = buildCurrentStep();
+        previewWorker.submit([source, timerName, compute, proxy, levelSize, visible, viewScale, step]() {
+            ScopedTimer timer(timerName);
+            return computeVisiblePreview(source, visible, viewScale, levelSize, step, proxy, compute);
+        });
+        return;
+    }
+
+    previewWorker.submit([source, timerName, compute, proxy, displaySize, levelSize]() {
+        ScopedTimer timer(timerName);
+        // 在代理图像上计算；Apply仍使用全分辨率图像
+        double scale = 1.0;
+        cv::Mat proxyImage = proxy->proxyFor(source, levelSize, &scale);
+        PreviewResult result = compute(proxyImage, scale);
+
+        // 粗结果放大到最终预览的尺寸，细化时预览区域的大小不跳变
+        double displayScale = ProxyPyramid::levelScale(source.size(), displaySize);
+        if (scale < displayScale && !result.image.empty()) {
+            cv::Size finalSize(std::max(1, (int)std::lround(source.cols * displayScale)),
+                               std::max(1, (int)std::lround(source.rows * displayScale)));
+            cv::Mat enlarged;
+            cv::resize(result.image, enlarged, finalSize, 0, 0, cv::INTER_NEAREST);
+            result.image = enlarged;
+        }
+        return result;
+    });
+}
+
+bool ImageProcessingApp::trackPreviewParameters() {
+    if (currentModal == ModalFunction::NONE || !processor.hasImage()) {
+        return false;
+    }
+
+    // 拖动时提交的是最粗一级，按它的实测耗时限速
+    PipelineStep step = buildCurrentStep();
+    double costMs = 0.0;
+    TimingStats stats;
+    if (step.module != PipelineModule::NONE &&
+        Profiler::getStats(previewTimerName(nextPreviewLevel(kCoarsePreviewLevel + 1)), stats)) {
+        costMs = stats.p50Ms;
+    }
+
+    if (!previewTracker.observe(step, costMs, ParameterTracker::Clock::now())) {
+        return false;
+    }
+    updatePreview();
+    return true;
+}
+
+bool ImageProcessingApp::refinePreview() {
+    if (previewRefineLevel <= 0 || !previewCompute || currentModal == ModalFunction::NONE) {
+        return false;
+    }
+    // 拖动滑块时保持粗分辨率，松开后再细化
+    if (previewWorker.isBusy() || cvui::mouse(cvui::IS_DOWN)) {
+        return false;
+    }
+    previewRefineLevel = nextPreviewLevel(previewRefineLevel);
+    submitPreviewLevel(previewRefineLevel);
+    return true;
+}
+
+int ImageProcessingApp::nextPreviewLevel(int level) {
+    // 图像本身较小时，相邻级别可能对应同一代理层，跳过重复的计算
+    cv::Size imageSize = previewSourceImage().size();
+    auto levelScale = [this, &imageSize](int index) {
+        cv::Size levelSize(std::max(1, previewAreaWidth >> index), std::max(1, previewAreaHeight >> index));
+        return ProxyPyramid::levelScale(imageSize, levelSize);
+    };
+
+    double currentScale = level > kCoarsePreviewLevel ? 0.0 : levelScale(level);
+    double displayScale = levelScale(0);
+    for (int next = level - 1; next > 0; next--) {
+        double nextScale = levelScale(next);
+        if (nextScale > currentScale && nextScale < displayScale) {
+            return next;
         }
+    }
+    return 0;
+}
 
+void ImageProcessingApp::renderSweepButton(int x, int y) {
+    SweepRange range;
+    if (!ParameterSweep::defaultRange(buildCurrentStep(), range)) {
+        return;
+    }
+    if (cvui::button(frame, x, y, 80, 30, "Sweep", 0.35)) {
+        startParameterSweep();
+    }
+}
+
+void ImageProcessingApp::startParameterSweep() {
+    PipelineStep step = buildCurrentStep();
+    SweepRange range;
+    if (!processor.hasImage() || !ParameterSweep::defaultRange(step, range)) {
+        return;
+    }
+
+    std::vector<double> values = ParameterSweep::values(range, kSweepCells);
+    cv::Mat source = previewSourceImage();
+    ProxyPyramid* proxy = &previewProxy;
+    cv::Size gridSize = previewViewSize();
+    bool zoomed = viewport.isZoomed();
+    cv::Rect visible = viewport.visibleRect(source.size(), gridSize);
+    double viewScale = viewport.pixelScale(source.size(), gridSize);
+
+    // 扫描网格替代普通预览，不再细化
+    previewCompute = nullptr;
+    previewRefineLevel = 0;
+    submittedPreviewView = cv::Rect();
+    sweepActive = true;
+    sweepRange = range;
+    sweepValues = values;
+
+    previewWorker.submit([source, proxy, gridSize, zoomed, visible, viewScale, step, range, values]() {
+        // 与预览相同的输入：放大时为可见区域，否则为适应预览区的代理图像
+        double scale = 1.0;
+        cv::Mat input;
+        if (zoomed) {
+            cv::Size visibleSize(std::max(1, (int)std::lround(visible.width * viewScale)),
+                                 std::max(1, (int)std::lround(visible.height * viewScale)));
+            scale = ProxyPyramid::levelScale(visible.size(), visibleSize);
+            input = source(visible);
+            if (scale < 1.0) {
+                cv::Mat reduced;
+                cv::resize(input, reduced, cv::Size(std::max(1, (int)std::lround(visible.width * scale)),
+                                                    std::max(1, (int)std::lround(visible.height * scale))),
+                           0, 0, cv::INTER_AREA);
+                input = reduced;
+            }
+        } else {
+            input = proxy->proxyFor(source, gridSize, &scale);
+        }
+
+        cv::Size cellSize = ParameterSweep::cellRect(0, (int)values.size(), gridSize).size();
+        std::vector<SweepCell> cells = ParameterSweep::run(input, step, range.paramIndex, values, scale, cellSize);
+
+        PreviewResult result;
+        result.image = ParameterSweep::composeGrid(cells, range, gridSize);
+        return result;
+    });
+
+    std::cout << "Parameter sweep: " << values.size() << " values of " << range.label << " from "
+              << values.front() << " to " << values.back() << std::endl;
+}
+
+void ImageProcessingApp::applySweepValue(double value) {
+    sweepActive = false;
+    std::cout << "Selected sweep value " << ParameterSweep::cellLabel(sweepRange, value) << std::endl;
+
+    switch (currentModal) {
+        case ModalFunction::SEGMENTATION:
+            switch (currentSegmentationFunction) {
+                case SegmentationFunction::BASIC_THRESHOLD:
+                    thresholdValue = value;
+                    break;
+                case SegmentationFunction::RANGE_THRESHOLD:
+                    thresholdMin = std::min(value, thresholdMax);
+                    break;
+                case SegmentationFunction::ADAPTIVE_THRESHOLD:
+                    blockSize = (int)value;
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case ModalFunction::MORPHOLOGY:
+            morphKernelSize = (int)value;
+            break;
+        default:
+            break;
+    }
+    // 值与当前参数相同时也要恢复普通预览
+    previewTracker.requestUpdate();
+}
+
+bool ImageProcessingApp::updatePreviewViewport() {
+    if (currentModal == ModalFunction::NONE || !previewCompute || !processor.hasImage()) {
+        return false;
+    }
+    if (!viewport.isZoomed() && submittedPreviewView.area() == 0) {
+        return false;
+    }
+    cv::Rect view = viewport.isZoomed() ? viewport.visibleRect(previewSourceImage().size(), previewViewSize()) : cv::Rect();
+    if (view == submittedPreviewView) {
+        return false;
+    }
+    submitPreview(previewCompute);
+    return true;
+}
+
+cv::Size ImageProcessingApp::mainViewSize() const {
+    // 减去边框宽度
+    return cv::Size(imageDisplayWidth - 4, imageDisplayHeight - 4);
+}
+
+cv::Size ImageProcessingApp::previewViewSize() const {
+    return cv::Size(previewAreaWidth - 10, previewAreaHeight - 10);
+}
+
+void ImageProcessingApp::renderPreview() {
+    int x = modalWindowX + 20;
+    int y = modalWindowY + 40;
+    if (sweepActive) {
+        // 网格按预览区的可用尺寸生成，居中1:1显示
+        cv::Rect area(x, y, previewAreaWidth, previewAreaHeight);
+        if (!previewWorker.isBusy() && cvui::mouse(cvui::CLICK) && area.contains(cvui::mouse())) {
+            cv::Size gridSize = previewViewSize();
+            cv::Point position = cvui::mouse() - cv::Point(x + (previewAreaWidth - gridSize.width) / 2,
+                                                           y + (previewAreaHeight - gridSize.height) / 2);
+            for (int i = 0; i < (int)sweepValues.size(); i++) {
+                if (ParameterSweep::cellRect(i, (int)sweepValues.size(), gridSize).contains(position)) {
+                    applySweepValue(sweepValues[i]);
+                    break;
+                }
+            }
+        }
+        cvui::text(frame, x, y + previewAreaHeight + 6, "Click a thumbnail to use its value", 0.35);
+    } else if (processor.hasImage()) {
+        cv::Size imageSize = previewSourceImage().size();
+        viewport.handleDrag(cv::Rect(x, y, previewAreaWidth, previewAreaHeight), cvui::mouse(), cvui::mouse(cvui::DOWN),
+                            cvui::mouse(cvui::IS_DOWN), imageSize, previewViewSize());
+        UIComponents::renderZoomControls(frame, x, y + previewAreaHeight + 2, 16, viewport, imageSize, previewViewSize());
+    }
+    UIComponents::renderPreviewArea(frame, x, y, previewAreaWidth, previewAreaHeight, previewImage, &previewDisplayCache,
+                                    previewDisplayRegion());
+}
+
+cv::Rect ImageProcessingApp::previewDisplayRegion() {
+    if (!viewport.isZoomed() || previewImage.empty() || sweepActive) {
+        return cv::Rect();
+    }
+
+    // 预览图像覆盖源图像中的previewRegion（为空表示整幅），把可见区域换算到预览图像的像素坐标
+    cv::Size sourceSize = previewSourceImage().size();
+    cv::Rect visible = viewport.visibleRect(sourceSize, previewViewSize());
+    cv::Rect covered = previewRegion.area() > 0 ? previewRegion : cv::Rect(cv::Point(), sourceSize);
+    cv::Rect shown = visible & covered;
+    if (shown.area() == 0) {
+        return cv::Rect();
+    }
+
+    double scaleX = (double)previewImage.cols / covered.width;
+    double scaleY = (double)previewImage.rows / covered.height;
+    int x0 = (int)std::floor((shown.x - covered.x) * scaleX);
+    int y0 = (int)std::floor((shown.y - covered.y) * scaleY);
+    int x1 = (int)std::ceil((shown.x + shown.width - covered.x) * scaleX);
+    int y1 = (int)std::ceil((shown.y + shown.height - covered.y) * scaleY);
+    return cv::Rect(x0, y0, std::max(1, x1 - x0), std::max(1, y1 - y0)) & cv::Rect(cv::Point(), previewImage.size());
+}
+
+bool ImageProcessingApp::collectPreviewResult() {
+    PreviewResult result;
+    if (!previewWorker.takeResult(result) || currentModal == ModalFunction::NONE) {
+        return false;
+    }
+    if (!result.image.empty()) {
+        previewImage = result.image;
+        previewRegion = result.region;
+    }
+    if (result.hasMeasurement) {
+        lastMeasurementResult = result.measurement;
+    }
+    return true;
+}
+
+
+// Recipe methods
+void ImageProcessingApp::recordStep(PipelineModule module, int function, const std::vector<double>& params) {
+    PipelineStep step(module, function, params);
+    // 已计算的结果直接填入缓存，之后修改该步或下游步骤时无需重新计算它
+    MeasurementResult measurement = module == PipelineModule::MEASUREMENTS ? lastMeasurementResult : MeasurementResult();
+    recipe.appendStep(step, processor.getCurrentImage(), measurement);
+    recordHistory(Pipeline::describeStep(step));
+    std::cout << "Recorded recipe step " << recipe.getSteps().size() << ": " << Pipeline::describeStep(step) << std::endl;
+}
+
+void ImageProcessingApp::recordHistory(const std::string& label) {
+    history.push(processor.getCurrentImage(), recipe.getSource(), recipe.getSteps(), label);
+}
+
+void ImageProcessingApp::undo() {
+    std::string label = history.undoLabel();
+    if (history.undo()) {
+        restoreHistoryState();
+        std::cout << "Undo: " << label << std::endl;
+    }
+}
+
+void ImageProcessingApp::redo() {
+    std::string label = history.redoLabel();
+    if (history.redo()) {
+        restoreHistoryState();
+        std::cout << "Redo: " << label << std::endl;
+    }
+}
+
+void ImageProcessingApp::restoreHistoryState() {
+    const HistoryEntry& entry = history.current();
+    processor.setCurrentImage(entry.image);
+    // 恢复流水线步骤；输入图像未变时缓存仍然有效
+    recipe.setSource(entry.source);
+    recipe.setSteps(entry.steps);
+}
+
+void ImageProcessingApp::updatePreview() {
+    switch (currentModal) {
+        case ModalFunction::PRE_PROCESSING:
+            if (currentPreProcessingFunction != PreProcessingFunction::NONE) {
+                updatePreProcessingPreview(currentPreProcessingFunction);
+            }
+            break;
+        case ModalFunction::COLOR_SELECT:
+            updateColorSelectPreview();
+            break;
+        case ModalFunction::COLOR_CLUSTER:
+            updateColorClusterPreview();
+            break;
+        case ModalFunction::COLOR_DECONVOLUTION:
+            updateColorDeconvolutionPreview();
+            break;
+        case ModalFunction::CHANNEL_OPERATION:
+            updateChannelOperationPreview();
+            break;
+        case ModalFunction::SEGMENTATION:
+            if (currentSegmentationFunction != SegmentationFunction::NONE) {
+                updateSegmentationPreview(currentSegmentationFunction);
+            }
+            break;
+        case ModalFunction::MORPHOLOGY:
+            if (currentMorphologyFunction != MorphologyFunction::NONE) {
+                updateMorphologyPreview(currentMorphologyFunction);
+            }
+            break;
+        case ModalFunction::CLEAN_UP:
+            if (currentCleanUpFunction != CleanUpFunction::NONE) {
+                updateCleanUpPreview(currentCleanUpFunction);
+            }
+            break;
+        case ModalFunction::MEASUREMENTS:
+            if (currentMeasurementsFunction != MeasurementsFunction::NONE) {
+                updateMeasurementsPreview(currentMeasurementsFunction);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+std::string ImageProcessingApp::previewTimerName(int level) const {
+    std::string name = "Preview " + Pipeline::timerName(buildCurrentStep());
+    if (level > 0) {
+        name += " 1/" + std::to_string(1 << level);
+    }
+    return name;
+}
+
+void ImageProcessingApp::renderTimingInfo(int x, int y) {
+    PipelineStep step = buildCurrentStep();
+    if (step.module == PipelineModule::NONE) {
+        return;
+    }
+
+    if (previewWorker.isBusy()) {
+        cvui::text(frame, x, y - 18, "Updating preview...", 0.33, 0xffd966);
+    }
+
+    // 预览的总耗时（含界面处理）与算法本身的耗时分开显示，便于判断慢在哪里
+    const std::string names[] = {previewTimerName(), Pipeline::timerName(step)};
+    const char* labels[] = {"Preview", "Function"};
+    for (int i = 0; i < 2; i++) {
+        TimingStats stats;
+        if (Profiler::getStats(names[i], stats)) {
+            std::stringstream ss;
+            ss << std::fixed << std::setprecision(1) << labels[i] << ": last " << stats.lastMs << " ms, p95 "
+               << stats.p95Ms << " ms (n=" << stats.count << ")";
+            cvui::text(frame, x, y + i * 18, ss.str().c_str(), 0.33);
+        }
+    }
+}
+
+cv::Mat ImageProcessingApp::previewSourceImage() {
+    // 编辑步骤时预览基于该步骤的输入（来自缓存），否则基于当前图像
+    if (editingStepIndex >= 0) {
+        return recipe.stageInput(editingStepIndex);
+    }
+    return processor.getCurrentImage();
+}
+
+PipelineStep ImageProcessingApp::buildCurrentStep() const {
+    switch (currentModal) {
+        case ModalFunction::PRE_PROCESSING:
+            switch (currentPreProcessingFunction) {
+                case PreProcessingFunction::NONE:
+                    return PipelineStep();
+                case PreProcessingFunction::ADJUST_CONTRAST:
+                    return PipelineStep(PipelineModule::PRE_PROCESSING, (int)currentPreProcessingFunction, {brightness, contrast});
+                case PreProcessingFunction::HISTOGRAM_EQUALIZATION:
+                    return PipelineStep(PipelineModule::PRE_PROCESSING, (int)currentPreProcessingFunction, {(double)histogramMethod, clipLimit});
+                case PreProcessingFunction::FLATTEN_BACKGROUND:
+                    return PipelineStep(PipelineModule::PRE_PROCESSING, (int)currentPreProcessingFunction, {(double)flattenKernelSize});
+                case PreProcessingFunction::SUM_FILTER:
+                    return PipelineStep(PipelineModule::PRE_PROCESSING, (int)currentPreProcessingFunction, kSumFilterParams);
+                case PreProcessingFunction::FFT_FILTER:
+                    return PipelineStep(PipelineModule::PRE_PROCESSING, (int)currentPreProcessingFunction,
+                                        {(double)fftMaskType, fftCutoff, fftUpperCutoff, fftNotchX, fftNotchY});
+                default:
+                    return PipelineStep(PipelineModule::PRE_PROCESSING, (int)currentPreProcessingFunction, {});
+            }
+        case ModalFunction::COLOR_SELECT:
+            return PipelineStep(PipelineModule::COLOR, (int)ColorFunction::COLOR_SELECT,
+                                {(double)hue_min, (double)hue_max, (double)sat_min, (double)sat_max, (double)val_min, (double)val_max});
+        case ModalFunction::COLOR_CLUSTER:
+            return PipelineStep(PipelineModule::COLOR, (int)ColorFunction::COLOR_CLUSTER, {(double)k_clusters});
+        case ModalFunction::COLOR_DECONVOLUTION:
+            return PipelineStep(PipelineModule::COLOR, (int)ColorFunction::COLOR_DECONVOLUTION, {(double)deconvolution_channel});
+        case ModalFunction::CHANNEL_OPERATION:
+            return PipelineStep(PipelineModule::COLOR, (int)ColorFunction::CHANNEL_OPERATION, {(double)operation_type, operation_value});
+        case ModalFunction::SEGMENTATION:
+            switch (currentSegmentationFunction) {
+                case SegmentationFunction::NONE:
+                    return PipelineStep();
+                case SegmentationFunction::BASIC_THRESHOLD:
+                    return PipelineStep(PipelineModule::SEGMENTATION, (int)currentSegmentationFunction, {thresholdValue, (double)thresholdType});
+                case SegmentationFunction::RANGE_THRESHOLD:
+                    return PipelineStep(PipelineModule::SEGMENTATION, (int)currentSegmentationFunction, {thresholdMin, thresholdMax});
+                case SegmentationFunction::ADAPTIVE_THRESHOLD:
+                    return PipelineStep(PipelineModule::SEGMENTATION, (int)currentSegmentationFunction,
+                                        {(double)adaptiveMethod, (double)thresholdType, (double)blockSize, C});
+                default:
+                    return PipelineStep(PipelineModule::SEGMENTATION, (int)currentSegmentationFunction, {});
+            }
+        case ModalFunction::MORPHOLOGY:
+            if (currentMorphologyFunction == MorphologyFunction::NONE) {
+                return PipelineStep();
+            }
+            return PipelineStep(PipelineModule::MORPHOLOGY, (int)currentMorphologyFunction,
+                                {(double)morphKernelSize, (double)morphKernelType, edgeThreshold, (double)separationMethod});
+        case ModalFunction::CLEAN_UP:
+            switch (currentCleanUpFunction) {
+                case CleanUpFunction::NONE:
+                    return PipelineStep();
+                case CleanUpFunction::FILL_ALL_HOLES:
+                    return PipelineStep(PipelineModule::CLEAN_UP, (int)currentCleanUpFunction, {(double)minHoleSize, (double)fillMethod});
+                case CleanUpFunction::REJECT_FEATURES:
+                    return PipelineStep(PipelineModule::CLEAN_UP, (int)currentCleanUpFunction,
+                                        {(double)minFeatureSize, (double)maxFeatureSize, (double)rejectMethod});
+                default:
+                    return PipelineStep(PipelineModule::CLEAN_UP, (int)currentCleanUpFunction, {});
+            }
+        case ModalFunction::MEASUREMENTS:
+            if (currentMeasurementsFunction == MeasurementsFunction::NONE) {
+                return PipelineStep();
+            }
+            return PipelineStep(PipelineModule::MEASUREMENTS, (int)currentMeasurementsFunction,
+                                {(double)minObjectSize, (double)maxObjectSize, sensitivity});
+        default:
+            return PipelineStep();
+    }
+}
+
+bool ImageProcessingApp::loadStepParameters(const PipelineStep& step) {
+    const std::vector<double>& p = step.params;
+    auto param = [&p](size_t index, double defaultValue) {
+        return index < p.size() ? p[index] : defaultValue;
+    };
+
+    switch (step.module) {
+        case PipelineModule::PRE_PROCESSING:
+            openModal(ModalFunction::PRE_PROCESSING);
+            currentPreProcessingFunction = static_cast<PreProcessingFunction>(step.function);
+            switch (currentPreProcessingFunction) {
+                case PreProcessingFunction::ADJUST_CONTRAST:
+                    brightness = param(0, 0.0);
+                    contrast = param(1, 1.0);
+                    break;
+                case PreProcessingFunction::HISTOGRAM_EQUALIZATION:
+                    histogramMethod = (int)param(0, 0);
+                    clipLimit = param(1, 2.0);
+                    break;
+                case PreProcessingFunction::FLATTEN_BACKGROUND:
+                    flattenKernelSize = (int)param(0, 15);
+                    break;
+                case PreProcessingFunction::FFT_FILTER:
+                    fftMaskType = (int)param(0, 0);
+                    fftCutoff = param(1, 0.16);
+                    fftUpperCutoff = param(2, 0.5);
+                    fftNotchX = param(3, 0.5);
+                    fftNotchY = param(4, 0.0);
+                    break;
+                default:
+                    break;
+            }
+            return true;
+        case PipelineModule::COLOR:
+            switch (static_cast<ColorFunction>(step.function)) {
+                case ColorFunction::COLOR_SELECT:
+                    openModal(ModalFunction::COLOR_SELECT);
+                    hue_min = (int)param(0, 0); hue_max = (int)param(1, 179);
+                    sat_min = (int)param(2, 0); sat_max = (int)param(3, 255);
+                    val_min = (int)param(4, 0); val_max = (int)param(5, 255);
+                    return true;
+                case ColorFunction::COLOR_CLUSTER:
+                    openModal(ModalFunction::COLOR_CLUSTER);
+                    k_clusters = (int)param(0, 3);
+                    return true;
+                case ColorFunction::COLOR_DECONVOLUTION:
+                    openModal(ModalFunction::COLOR_DECONVOLUTION);
+                    deconvolution_channel = (int)param(0, 0);
+                    return true;
+                case ColorFunction::CHANNEL_OPERATION:
+                    openModal(ModalFunction::CHANNEL_OPERATION);
+                    operation_type = (int)param(0, 0);
+                    operation_value = param(1, 1.0);
+                    return true;
+                default:
+                    // 灰度转换没有参数可编辑
+                    return false;
+            }
+        case PipelineModule::SEGMENTATION:
+            openModal(ModalFunction::SEGMENTATION);
+            currentSegmentationFunction = static_cast<SegmentationFunction>(step.function);
+            switch (currentSegmentationFunction) {
+                case SegmentationFunction::BASIC_THRESHOLD:
+                    thresholdValue = param(0, 127.0);
+                    thresholdType = (int)param(1, 0);
+                    break;
+                case SegmentationFunction::RANGE_THRESHOLD:
+                    thresholdMin = param(0, 50.0);
+                    thresholdMax = param(1, 200.0);
+                    break;
+                case SegmentationFunction::ADAPTIVE_THRESHOLD:
+                    adaptiveMethod = (int)param(0, 0);
+                    thresholdType = (int)param(1, 0);
+                    blockSize = (int)param(2, 11);
+                    C = param(3, 2.0);
+                    break;
+                default:
+                    break;
+            }
+            return true;
+        case PipelineModule::MORPHOLOGY:
+            openModal(ModalFunction::MORPHOLOGY);
+            currentMorphologyFunction = static_cast<MorphologyFunction>(step.function);
+            morphKernelSize = (int)param(0, 5);
+            morphKernelType = (int)param(1, 1);
+            edgeThreshold = param(2, 100.0);
+            separationMethod = (int)param(3, 0);
+            return true;
+        case PipelineModule::CLEAN_UP:
+            openModal(ModalFunction::CLEAN_UP);
+            currentCleanUpFunction = static_cast<CleanUpFunction>(step.function);
+            switch (currentCleanUpFunction) {
+                case CleanUpFunction::FILL_ALL_HOLES:
+                    minHoleSize = (int)param(0, 50);
+                    fillMethod = (int)param(1, 0);
+                    break;
+                case CleanUpFunction::REJECT_FEATURES:
+                    minFeatureSize = (int)param(0, 10);
+                    maxFeatureSize = (int)param(1, 1000);
+                    rejectMethod = (int)param(2, 0);
+                    break;
+                default:
+                    break;
+            }
+            return true;
+        case PipelineModule::MEASUREMENTS:
+            openModal(ModalFunction::MEASUREMENTS);
+            currentMeasurementsFunction = static_cast<MeasurementsFunction>(step.function);
+            minObjectSize = (int)param(0, 10);
+            maxObjectSize = (int)param(1, 10000);
+            sensitivity = param(2, 0.5);
+            return true;
+        default:
+            return false;
+    }
+}
+
+void ImageProcessingApp::applyEditedStep() {
+    PipelineStep step = buildCurrentStep();
+    if (step.module == PipelineModule::NONE || editingStepIndex >= (int)recipe.getSteps().size()) {
+        return;
+    }
+
+    try {
+        recipe.replaceStep(editingStepIndex, step);
+
+        MeasurementResult measurement;
+        cv::Mat result = recipe.run(&measurement);
+        if (!result.empty()) {
+            processor.setCurrentImage(std::move(result));
+            for (const PipelineStep& s : recipe.getSteps()) {
+                if (s.module == PipelineModule::MEASUREMENTS) {
+                    lastMeasurementResult = measurement;
+                    break;
+                }
+            }
+            recordHistory("Edit step " + std::to_string(editingStepIndex + 1));
+        }
+
+        recipeStatus = "Updated step " + std::to_string(editingStepIndex + 1) + ", recomputed " +
+                       std::to_string(recipe.getLastExecutedStages()) + " of " + std::to_string(recipe.getSteps().size()) + " steps";
+        std::cout << recipeStatus << std::endl;
     } catch (const std::exception& e) {
-        std::cout << "Error updating measurements preview: " << e.what() << std::endl;
+        std::cout << "Error re-running recipe: " << e.what() << std::endl;
+    }
+}
+
+void ImageProcessingApp::renderRecipeModal() {
+    cvui::window(frame, modalWindowX, modalWindowY, modalWindowWidth, modalWindowHeight, "Recipe", 0.4);
+
+    // 步骤列表
+    int currentY = modalWindowY + 40;
+    const std::vector<PipelineStep> steps = recipe.getSteps();
+    cvui::text(frame, modalWindowX + 20, currentY, ("Recorded steps: " + std::to_string(steps.size())).c_str(), 0.4);
+    currentY += 30;
+
+    if (steps.empty()) {
+        cvui::text(frame, modalWindowX + 20, currentY, "No steps recorded yet. Every Apply is recorded here.", 0.35);
+    }
+    for (size_t i = 0; i < steps.size() && currentY < modalWindowY + modalWindowHeight - 40; i++) {
+        std::string line = std::to_string(i + 1) + ". " + Pipeline::describeStep(steps[i]);
+        cvui::text(frame, modalWindowX + 20, currentY + 5, line.c_str(), 0.35);
+
+        // 编辑：打开该步骤的模态窗口并恢复参数，Apply后只重新计算该步及其下游
+        if (cvui::button(frame, modalWindowX + 330, currentY, 50, 20, "Edit", 0.3)) {
+            if (loadStepParameters(steps[i])) {
+                editingStepIndex = (int)i;
+                previewImage = cv::Mat();
+                previewTracker.requestUpdate();
+                return;
+            }
+            recipeStatus = "Step " + std::to_string(i + 1) + " has no parameters to edit";
+        }
+
+        if (cvui::button(frame, modalWindowX + 385, currentY, 60, 20, "Remove", 0.3)) {
+            try {
+                recipe.removeStep(i);
+                MeasurementResult measurement;
+                cv::Mat result = recipe.run(&measurement);
+                if (!result.empty()) {
+                    processor.setCurrentImage(std::move(result));
+                    lastMeasurementResult = measurement;
+                }
+                recordHistory("Remove step " + std::to_string(i + 1));
+                recipeStatus = "Removed step " + std::to_string(i + 1) + ", recomputed " +
+                               std::to_string(recipe.getLastExecutedStages()) + " steps";
+            } catch (const std::exception& e) {
+                recipeStatus = std::string("Replay failed: ") + e.what();
+            }
+            return;
+        }
+        currentY += 24;
+    }
+
+    // 控制区域
+    const char* recipeFilter = "Recipe Files\0*.yml;*.yaml;*.json\0All Files\0*.*\0";
+    int buttonY = controlAreaY;
+
+    if (cvui::button(frame, controlAreaX + 100, buttonY, 150, 30, "Save Recipe", 0.35)) {
+        std::string path = saveFileDialog(recipeFilter, "yml");
+        if (!path.empty()) {
+            // 超大图像只加载了缩小的层级，配方按全分辨率保存，批处理在原图上重放时参数才一致
+            double loadScale = processor.getLoadScale();
+            Pipeline pipeline;
+            for (const PipelineStep& step : steps) {
+                pipeline.addStep(ProxyPyramid::scaleStep(step, 1.0 / loadScale));
+            }
+            recipeStatus = pipeline.saveToFile(path) ? "Saved to " + path : "Failed to save " + path;
+        }
+    }
+    buttonY += 40;
+
+    if (cvui::button(frame, controlAreaX + 100, buttonY, 150, 30, "Load & Replay", 0.35)) {
+        std::string path = openFileDialog(recipeFilter);
+        Pipeline loaded;
+        if (!path.empty() && !processor.hasImage()) {
+            recipeStatus = "Please load an image first.";
+        } else if (!path.empty() && loaded.loadFromFile(path)) {
+            try {
+                // 配方按全分辨率保存，换算到当前加载的层级
+                double loadScale = processor.getLoadScale();
+                for (const PipelineStep& step : loaded.getSteps()) {
+                    recipe.appendStep(ProxyPyramid::scaleStep(step, loadScale));
+                }
+                MeasurementResult measurement;
+                cv::Mat result = recipe.run(&measurement);
+                if (!result.empty()) {
+                    processor.setCurrentImage(std::move(result));
+                    lastMeasurementResult = measurement;
+                }
+                recordHistory("Replay " + path);
+                recipeStatus = "Replayed " + std::to_string(loaded.getSteps().size()) + " steps from " + path;
+            } catch (const std::exception& e) {
+                recipeStatus = std::string("Replay failed: ") + e.what();
+            }
+        } else if (!path.empty()) {
+            recipeStatus = "Failed to load " + path;
+        }
+    }
+    buttonY += 40;
+
+    if (cvui::button(frame, controlAreaX + 100, buttonY, 150, 30, "Clear Recipe", 0.35)) {
+        // 以当前图像作为新的起点
+        recipe.setSource(processor.getCurrentImage());
+        recordHistory("Clear recipe");
+        recipeStatus = "Recipe cleared";
+    }
+    buttonY += 40;
+
+    if (cvui::button(frame, controlAreaX + 100, buttonY, 150, 30, "Close", 0.35)) {
+        closeModal();
+        return;
+    }
+    buttonY += 50;
+
+    if (!recipeStatus.empty()) {
+        cvui::text(frame, controlAreaX + 100, buttonY, recipeStatus.c_str(), 0.3);
     }
 }
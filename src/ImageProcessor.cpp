@@ -1,7 +1,17 @@
 #include "ImageProcessor.h"
+#include "Logger.h"
+#include "ColorProcessing.h"
+#include "TiffImageSource.h"
 #include <iostream>
 
-ImageProcessor::ImageProcessor() {
+namespace {
+
+// 交互处理的图像上限；超过时从TIFF金字塔中选择较小的层级
+const size_t kMaxInteractivePixels = (size_t)8192 * 8192;
+
+}
+
+ImageProcessor::ImageProcessor() : imageVersion(0) {
     std::cout << "ImageProcessor initialized" << std::endl;
 }
 
@@ -9,27 +19,60 @@ ImageProcessor::~ImageProcessor() {
 }
 
 bool ImageProcessor::loadImage(const std::string& path) {
-    cv::Mat image = cv::imread(path);
+    // 分块/条带TIFF只解码需要的层级，其他格式由cv::imread整体解码。
+    // 来源只在加载期间使用，函数返回时释放，其分块缓存不会与解码结果同时驻留
+    std::shared_ptr<TileSource> source = TiffImageSource::openFile(path);
+    cv::Mat image;
+    int level = 0;
+
+    if (source) {
+        std::shared_ptr<TiffImageSource> tiff = std::dynamic_pointer_cast<TiffImageSource>(source);
+        if (tiff) {
+            level = tiff->levelForPixels(kMaxInteractivePixels);
+            cv::Size levelSize = tiff->levelSize(level);
+            image = tiff->readRegion(cv::Rect(0, 0, levelSize.width, levelSize.height), level);
+        } else {
+            // MatTileSource返回的是与解码结果共享缓冲区的视图
+            image = source->readRegion(cv::Rect(cv::Point(), source->size()));
+        }
+    }
     
     if (image.empty()) {
         std::cout << "Failed to load image: " << path << std::endl;
         return false;
     }
     
-    originalImage = image.clone();
-    currentImage = image.clone();
+    // 原始图像与当前图像共享缓冲区，处理结果总是写入新图像
+    originalImage = image;
+    currentImage = image;
     imagePath = path;
+    fullSize = source->size();
     updateDisplayImage();
     
     std::cout << "Successfully loaded image: " << path << std::endl;
     std::cout << "Image size: " << image.cols << "x" << image.rows << std::endl;
+    if (level > 0) {
+        LOG_WARN("Loaded pyramid level " << level << " (" << image.cols << "x" << image.rows << ") of "
+                 << fullSize.width << "x" << fullSize.height << " image; processing runs at this reduced resolution");
+    }
     
     return true;
 }
 
+cv::Size ImageProcessor::getFullSize() const {
+    return fullSize;
+}
+
+double ImageProcessor::getLoadScale() const {
+    if (originalImage.empty() || fullSize.width <= 0) {
+        return 1.0;
+    }
+    return (double)originalImage.cols / fullSize.width;
+}
+
 void ImageProcessor::resetToOriginal() {
     if (!originalImage.empty()) {
-        currentImage = originalImage.clone();
+        currentImage = originalImage;
         updateDisplayImage();
         std::cout << "Image reset to original" << std::endl;
     }
@@ -43,13 +86,15 @@ const cv::Mat& ImageProcessor::getDisplayImage() const {
     return displayImage;
 }
 
+uint64_t ImageProcessor::getImageVersion() const {
+    return imageVersion;
+}
+
 void ImageProcessor::convertToGrayscale() {
     ensureImageLoaded();
 
     if (currentImage.channels() == 3) {
-        cv::Mat grayImage;
-        cv::cvtColor(currentImage, grayImage, cv::COLOR_BGR2GRAY);
-        currentImage = grayImage.clone(); // Keep as single channel grayscale
+        currentImage = ColorProcessing::convertToGrayscale(currentImage); // Keep as single channel grayscale
         updateDisplayImage();
         std::cout << "Converted to grayscale (channels=" << currentImage.channels() << ")" << std::endl;
     } else {
@@ -60,7 +105,7 @@ void ImageProcessor::convertToGrayscale() {
 void ImageProcessor::colorSelect(int hue_min, int hue_max, int sat_min, int sat_max, int val_min, int val_max) {
     ensureImageLoaded();
 
-    std::cout << "DEBUG: colorSelect input - channels=" << currentImage.channels() << std::endl;
+    LOG_DEBUG("colorSelect input - channels=" << currentImage.channels());
 
     // Color selection only works on 3-channel images
     if (currentImage.channels() != 3) {
@@ -68,17 +113,7 @@ void ImageProcessor::colorSelect(int hue_min, int hue_max, int sat_min, int sat_
         return;
     }
 
-    cv::Mat hsv, mask, result;
-    cv::cvtColor(currentImage, hsv, cv::COLOR_BGR2HSV);
-
-    cv::Scalar lower(hue_min, sat_min, val_min);
-    cv::Scalar upper(hue_max, sat_max, val_max);
-    cv::inRange(hsv, lower, upper, mask);
-
-    // Initialize result with zeros and same type as currentImage
-    result = cv::Mat::zeros(currentImage.size(), currentImage.type());
-    currentImage.copyTo(result, mask);
-    currentImage = result;
+    currentImage = ColorProcessing::colorSelect(currentImage, hue_min, hue_max, sat_min, sat_max, val_min, val_max);
     updateDisplayImage();
 
     std::cout << "Applied color selection" << std::endl;
@@ -87,7 +122,7 @@ void ImageProcessor::colorSelect(int hue_min, int hue_max, int sat_min, int sat_
 void ImageProcessor::colorCluster(int k) {
     ensureImageLoaded();
 
-    std::cout << "DEBUG: colorCluster input - channels=" << currentImage.channels() << std::endl;
+    LOG_DEBUG("colorCluster input - channels=" << currentImage.channels());
 
     // Color clustering only works on 3-channel images
     if (currentImage.channels() != 3) {
@@ -95,7 +130,7 @@ void ImageProcessor::colorCluster(int k) {
         return;
     }
 
-    currentImage = performKMeans(currentImage, k);
+    currentImage = ColorProcessing::colorCluster(currentImage, k);
     updateDisplayImage();
     std::cout << "Applied K-means clustering with k=" << k << std::endl;
 }
@@ -103,7 +138,7 @@ void ImageProcessor::colorCluster(int k) {
 void ImageProcessor::colorDeconvolution(int channel) {
     ensureImageLoaded();
 
-    std::cout << "DEBUG: colorDeconvolution input - channels=" << currentImage.channels() << std::endl;
+    LOG_DEBUG("colorDeconvolution input - channels=" << currentImage.channels());
 
     // Color deconvolution only works on 3-channel images
     if (currentImage.channels() != 3) {
@@ -111,12 +146,9 @@ void ImageProcessor::colorDeconvolution(int channel) {
         return;
     }
 
-    std::vector<cv::Mat> channels;
-    cv::split(currentImage, channels);
-
-    if (channel >= 0 && channel < channels.size()) {
+    if (channel >= 0 && channel < currentImage.channels()) {
         // Extract single channel and keep as grayscale (1-channel)
-        currentImage = channels[channel].clone();
+        currentImage = ColorProcessing::colorDeconvolution(currentImage, channel);
         updateDisplayImage();
         std::cout << "Applied color deconvolution on channel " << channel << ", result is grayscale" << std::endl;
     }
@@ -125,22 +157,20 @@ void ImageProcessor::colorDeconvolution(int channel) {
 void ImageProcessor::channelOperation(const std::string& operation, double value) {
     ensureImageLoaded();
 
-    std::cout << "DEBUG: channelOperation input - channels=" << currentImage.channels() << std::endl;
+    LOG_DEBUG("channelOperation input - channels=" << currentImage.channels());
 
-    cv::Mat result;
+    int operationIndex = -1;
     if (operation == "add") {
-        cv::add(currentImage, cv::Scalar::all(value), result);
+        operationIndex = 0;
     } else if (operation == "subtract") {
-        cv::subtract(currentImage, cv::Scalar::all(value), result);
+        operationIndex = 1;
     } else if (operation == "multiply") {
-        cv::multiply(currentImage, cv::Scalar::all(value), result);
+        operationIndex = 2;
     } else if (operation == "divide") {
-        cv::divide(currentImage, cv::Scalar::all(value), result);
-    } else {
-        result = currentImage.clone();
+        operationIndex = 3;
     }
 
-    currentImage = result;
+    currentImage = ColorProcessing::channelOperation(currentImage, operationIndex, value);
     updateDisplayImage();
     std::cout << "Applied channel operation: " << operation << " with value " << value
               << ", result channels=" << currentImage.channels() << std::endl;
@@ -158,67 +188,91 @@ cv::Size ImageProcessor::getImageSize() const {
 }
 
 void ImageProcessor::updateDisplayImage() {
+    // 所有修改当前图像的路径都经过这里
+    imageVersion++;
     if (!currentImage.empty()) {
         // Convert to 3-channel for display if needed
         if (currentImage.channels() == 1) {
             // 确保使用正确的转换方式，并创建新的Mat对象而不是直接赋值
             cv::cvtColor(currentImage, displayImage, cv::COLOR_GRAY2BGR);
         } else {
-            // 使用clone()创建一个深拷贝，避免共享内存
-            displayImage = currentImage.clone();
+            // 与当前图像共享缓冲区，显示路径只读
+            displayImage = currentImage;
         }
-        std::cout << "DEBUG: updateDisplayImage - currentImage size: " << currentImage.cols << "x" << currentImage.rows
-                  << ", channels: " << currentImage.channels() << std::endl;
-        std::cout << "DEBUG: displayImage updated to size: " << displayImage.cols << "x" << displayImage.rows
-                  << ", channels: " << displayImage.channels() << std::endl;
+        LOG_DEBUG("updateDisplayImage - currentImage size: " << currentImage.cols << "x" << currentImage.rows
+                  << ", channels: " << currentImage.channels());
+        LOG_DEBUG("displayImage updated to size: " << displayImage.cols << "x" << displayImage.rows
+                  << ", channels: " << displayImage.channels());
     }
 }
 
 void ImageProcessor::setCurrentImage(const cv::Mat& image) {
     if (!image.empty()) {
-        std::cout << "DEBUG: setCurrentImage called with image size: " << image.cols << "x" << image.rows << std::endl;
-        currentImage = image.clone();
+        LOG_DEBUG("setCurrentImage called with image size: " << image.cols << "x" << image.rows);
+        currentImage = image;
+        updateDisplayImage();
+        LOG_DEBUG("setCurrentImage completed");
+    } else {
+        LOG_DEBUG("setCurrentImage called with empty image!");
+    }
+}
+
+void ImageProcessor::setCurrentImage(cv::Mat&& image) {
+    if (!image.empty()) {
+        LOG_DEBUG("setCurrentImage called with image size: " << image.cols << "x" << image.rows);
+        currentImage = std::move(image);
         updateDisplayImage();
-        std::cout << "DEBUG: setCurrentImage completed" << std::endl;
+        LOG_DEBUG("setCurrentImage completed");
     } else {
-        std::cout << "DEBUG: setCurrentImage called with empty image!" << std::endl;
+        LOG_DEBUG("setCurrentImage called with empty image!");
     }
 }
 
 void ImageProcessor::applyPreProcessedImage(const cv::Mat& processedImage) {
     if (!processedImage.empty()) {
-        std::cout << "DEBUG: applyPreProcessedImage called with image size: " << processedImage.cols << "x" << processedImage.rows
-                  << ", channels: " << processedImage.channels() << std::endl;
-        std::cout << "DEBUG: currentImage before replacement: channels=" << currentImage.channels() << std::endl;
+        LOG_DEBUG("applyPreProcessedImage called with image size: " << processedImage.cols << "x" << processedImage.rows
+                  << ", channels: " << processedImage.channels());
+        LOG_DEBUG("currentImage before replacement: channels=" << currentImage.channels());
 
         // 直接使用处理后的图像，不强制类型转换（支持串行流程中的通道变化）
-        currentImage = processedImage.clone();
+        currentImage = processedImage;
+
+        LOG_DEBUG("currentImage after replacement: channels=" << currentImage.channels());
+        LOG_DEBUG("Calling updateDisplayImage()");
+        updateDisplayImage();
+        LOG_DEBUG("applyPreProcessedImage completed");
+    } else {
+        LOG_DEBUG("applyPreProcessedImage called with empty image!");
+    }
+}
 
-        std::cout << "DEBUG: currentImage after replacement: channels=" << currentImage.channels() << std::endl;
-        std::cout << "DEBUG: Calling updateDisplayImage()" << std::endl;
+void ImageProcessor::applyPreProcessedImage(cv::Mat&& processedImage) {
+    if (!processedImage.empty()) {
+        LOG_DEBUG("applyPreProcessedImage called with image size: " << processedImage.cols << "x" << processedImage.rows
+                  << ", channels: " << processedImage.channels());
+        currentImage = std::move(processedImage);
         updateDisplayImage();
-        std::cout << "DEBUG: applyPreProcessedImage completed" << std::endl;
     } else {
-        std::cout << "DEBUG: applyPreProcessedImage called with empty image!" << std::endl;
+        LOG_DEBUG("applyPreProcessedImage called with empty image!");
     }
 }
 
 // 预处理功能 - 直接模仿其他工作功能的模式
 void ImageProcessor::adjustContrast(double brightness, double contrast) {
     ensureImageLoaded();
-    std::cout << "DEBUG: adjustContrast called with brightness=" << brightness << ", contrast=" << contrast << std::endl;
+    LOG_DEBUG("adjustContrast called with brightness=" << brightness << ", contrast=" << contrast);
     
     cv::Mat result;
     currentImage.convertTo(result, currentImage.type(), contrast, brightness);
     currentImage = result;
     updateDisplayImage();
     
-    std::cout << "DEBUG: adjustContrast completed, image updated" << std::endl;
+    LOG_DEBUG("adjustContrast completed, image updated");
 }
 
 void ImageProcessor::applyHistogramEqualization(int method, double clipLimit) {
     ensureImageLoaded();
-    std::cout << "DEBUG: applyHistogramEqualization called with method=" << method << ", clipLimit=" << clipLimit << std::endl;
+    LOG_DEBUG("applyHistogramEqualization called with method=" << method << ", clipLimit=" << clipLimit);
     
     cv::Mat result;
     
@@ -255,12 +309,12 @@ void ImageProcessor::applyHistogramEqualization(int method, double clipLimit) {
     currentImage = result;
     updateDisplayImage();
     
-    std::cout << "DEBUG: applyHistogramEqualization completed, image updated" << std::endl;
+    LOG_DEBUG("applyHistogramEqualization completed, image updated");
 }
 
 void ImageProcessor::flattenBackground(int kernelSize) {
     ensureImageLoaded();
-    std::cout << "DEBUG: flattenBackground called with kernelSize=" << kernelSize << std::endl;
+    LOG_DEBUG("flattenBackground called with kernelSize=" << kernelSize);
     
     cv::Mat result;
     cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(kernelSize, kernelSize));
@@ -268,7 +322,7 @@ void ImageProcessor::flattenBackground(int kernelSize) {
     currentImage = result;
     updateDisplayImage();
     
-    std::cout << "DEBUG: flattenBackground completed, image updated" << std::endl;
+    LOG_DEBUG("flattenBackground completed, image updated");
 }
 
 void ImageProcessor::ensureImageLoaded() const {
@@ -278,24 +332,5 @@ void ImageProcessor::ensureImageLoaded() const {
 }
 
 cv::Mat ImageProcessor::performKMeans(const cv::Mat& image, int k) {
-    cv::Mat data;
-    image.reshape(1, image.rows * image.cols).convertTo(data, CV_32F);
-    
-    cv::Mat labels, centers;
-    cv::kmeans(data, k, labels, cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 20, 1.0), 3, cv::KMEANS_PP_CENTERS, centers);
-    
-    cv::Mat result(image.size(), image.type());
-    for (int i = 0; i < image.rows * image.cols; i++) {
-        int cluster = labels.at<int>(i);
-        if (image.channels() == 1) {
-            result.at<uchar>(i / image.cols, i % image.cols) = static_cast<uchar>(centers.at<float>(cluster, 0));
-        } else {
-            cv::Vec3b color(static_cast<uchar>(centers.at<float>(cluster, 0)),
-                           static_cast<uchar>(centers.at<float>(cluster, 1)),
-                           static_cast<uchar>(centers.at<float>(cluster, 2)));
-            result.at<cv::Vec3b>(i / image.cols, i % image.cols) = color;
-        }
-    }
-    
-    return result;
+    return ColorProcessing::performKMeans(image, k);
 }
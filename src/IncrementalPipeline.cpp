@@ -0,0 +1,159 @@
+#include "IncrementalPipeline.h"
+#include "Logger.h"
+#include <algorithm>
+#include <tuple>
+
+bool IncrementalPipeline::StageKey::operator<(const StageKey& other) const {
+    return std::tie(inputId, module, function, params) <
+           std::tie(other.inputId, other.module, other.function, other.params);
+}
+
+IncrementalPipeline::IncrementalPipeline()
+    : sourceId(0), nextId(1), useClock(0), cacheBudgetBytes((size_t)1024 * 1024 * 1024), lastExecutedStages(0) {
+}
+
+IncrementalPipeline::~IncrementalPipeline() {
+}
+
+void IncrementalPipeline::setSource(const cv::Mat& image) {
+    steps.clear();
+    if (!source.empty() && image.data == source.data && image.size() == source.size() && image.type() == source.type()) {
+        return;
+    }
+    source = image;
+    sourceId = nextId++;
+    cache.clear();
+}
+
+const cv::Mat& IncrementalPipeline::getSource() const {
+    return source;
+}
+
+void IncrementalPipeline::clearSteps() {
+    steps.clear();
+}
+
+void IncrementalPipeline::appendStep(const PipelineStep& step) {
+    steps.push_back(step);
+}
+
+void IncrementalPipeline::appendStep(const PipelineStep& step, const cv::Mat& result, const MeasurementResult& measurement) {
+    uint64_t tailId = sourceId;
+    evaluate(steps.size(), nullptr, &tailId);
+
+    StageResult entry;
+    entry.image = result;
+    entry.measurement = measurement;
+    entry.resultId = nextId++;
+    entry.lastUsed = useClock;
+    cache[makeKey(tailId, step)] = entry;
+
+    steps.push_back(step);
+    enforceBudget();
+}
+
+void IncrementalPipeline::setSteps(const std::vector<PipelineStep>& newSteps) {
+    steps = newSteps;
+}
+
+void IncrementalPipeline::replaceStep(size_t index, const PipelineStep& step) {
+    if (index < steps.size()) {
+        steps[index] = step;
+    }
+}
+
+void IncrementalPipeline::removeStep(size_t index) {
+    if (index < steps.size()) {
+        steps.erase(steps.begin() + index);
+    }
+}
+
+const std::vector<PipelineStep>& IncrementalPipeline::getSteps() const {
+    return steps;
+}
+
+cv::Mat IncrementalPipeline::run(MeasurementResult* lastMeasurement) {
+    return evaluate(steps.size(), lastMeasurement, nullptr);
+}
+
+cv::Mat IncrementalPipeline::stageInput(size_t index) {
+    return evaluate(std::min(index, steps.size()), nullptr, nullptr);
+}
+
+void IncrementalPipeline::setCacheBudget(size_t bytes) {
+    cacheBudgetBytes = bytes;
+    enforceBudget();
+}
+
+int IncrementalPipeline::getLastExecutedStages() const {
+    return lastExecutedStages;
+}
+
+size_t IncrementalPipeline::getCachedBytes() const {
+    size_t total = 0;
+    for (const auto& item : cache) {
+        total += item.second.image.total() * item.second.image.elemSize();
+    }
+    return total;
+}
+
+cv::Mat IncrementalPipeline::evaluate(size_t count, MeasurementResult* lastMeasurement, uint64_t* resultId) {
+    useClock++;
+    lastExecutedStages = 0;
+
+    cv::Mat current = source;
+    uint64_t currentId = sourceId;
+
+    for (size_t i = 0; i < count && i < steps.size(); i++) {
+        StageKey key = makeKey(currentId, steps[i]);
+        auto it = cache.find(key);
+        if (it == cache.end()) {
+            StageResult entry;
+            entry.image = Pipeline::applyStep(current, steps[i], &entry.measurement);
+            entry.resultId = nextId++;
+            it = cache.emplace(key, entry).first;
+            lastExecutedStages++;
+            LOG_DEBUG("IncrementalPipeline recomputed stage " << i << ": " << Pipeline::describeStep(steps[i]));
+        }
+
+        it->second.lastUsed = useClock;
+        current = it->second.image;
+        currentId = it->second.resultId;
+        if (lastMeasurement && steps[i].module == PipelineModule::MEASUREMENTS) {
+            *lastMeasurement = it->second.measurement;
+        }
+    }
+
+    if (resultId) {
+        *resultId = currentId;
+    }
+    enforceBudget();
+    return current;
+}
+
+void IncrementalPipeline::enforceBudget() {
+    size_t total = getCachedBytes();
+    while (total > cacheBudgetBytes) {
+        // 淘汰最久未使用的结果，当前链上的结果（lastUsed == useClock）保留
+        auto victim = cache.end();
+        for (auto it = cache.begin(); it != cache.end(); ++it) {
+            if (it->second.lastUsed < useClock && (victim == cache.end() || it->second.lastUsed < victim->second.lastUsed)) {
+                victim = it;
+            }
+        }
+        if (victim == cache.end()) {
+            break;
+        }
+        total -= victim->second.image.total() * victim->second.image.elemSize();
+        cache.erase(victim);
+    }
+}
+
+IncrementalPipeline::StageKey IncrementalPipeline::makeKey(uint64_t inputId, const PipelineStep& step) {
+    StageKey key;
+    key.inputId = inputId;
+    key.module = (int)step.module;
+    key.function = step.function;
+    key.params = step.params;
+    return key;
+}
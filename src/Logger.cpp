@@ -0,0 +1,142 @@
+#include "Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+namespace {
+
+const size_t kRingSize = 4096;          // 环形缓冲区条数，必须是2的幂
+const size_t kMessageSize = 240;        // 单条消息的最大长度（含结尾0）
+
+/**
+ * @brief 环形缓冲区的一个槽位
+ * sequence为0表示正在写入，否则为写入序号+1；读取时前后两次sequence一致才视为有效
+ */
+struct RingSlot {
+    std::atomic<uint64_t> sequence;
+    LogLevel level;
+    int64_t timestampNs;
+    char text[kMessageSize];
+};
+
+RingSlot ring[kRingSize];
+std::atomic<uint64_t> writeCount(0);
+std::atomic<int> captureLevel((int)LogLevel::DEBUG);
+std::atomic<int> consoleLevel(-1);      // -1表示尚未读取环境变量
+std::mutex consoleMutex;
+
+int currentConsoleLevel() {
+    int level = consoleLevel.load(std::memory_order_relaxed);
+    if (level < 0) {
+        const char* env = std::getenv("IP_LOG_LEVEL");
+        int initial = (int)(env ? Logger::levelFromName(env, LogLevel::INFO) : LogLevel::INFO);
+        consoleLevel.compare_exchange_strong(level, initial);
+        level = consoleLevel.load(std::memory_order_relaxed);
+    }
+    return level;
+}
+
+}
+
+bool Logger::isEnabled(LogLevel level) {
+    int value = (int)level;
+    return value >= captureLevel.load(std::memory_order_relaxed) || value >= currentConsoleLevel();
+}
+
+void Logger::write(LogLevel level, const std::string& message) {
+    int value = (int)level;
+
+    if (value >= captureLevel.load(std::memory_order_relaxed)) {
+        uint64_t index = writeCount.fetch_add(1, std::memory_order_relaxed);
+        RingSlot& slot = ring[index & (kRingSize - 1)];
+
+        slot.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.level = level;
+        slot.timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        size_t length = std::min(message.size(), kMessageSize - 1);
+        std::memcpy(slot.text, message.data(), length);
+        slot.text[length] = '\0';
+
+        slot.sequence.store(index + 1, std::memory_order_release);
+    }
+
+    if (value >= currentConsoleLevel()) {
+        std::lock_guard<std::mutex> lock(consoleMutex);
+        std::cout << "[" << levelName(level) << "] " << message << '\n';
+        if (level >= LogLevel::WARN) {
+            std::cout.flush();
+        }
+    }
+}
+
+void Logger::setCaptureLevel(LogLevel level) {
+    captureLevel.store((int)level, std::memory_order_relaxed);
+}
+
+void Logger::setConsoleLevel(LogLevel level) {
+    consoleLevel.store((int)level, std::memory_order_relaxed);
+}
+
+LogLevel Logger::getConsoleLevel() {
+    return (LogLevel)currentConsoleLevel();
+}
+
+std::vector<LogRecord> Logger::recent(size_t maxCount) {
+    std::vector<LogRecord> records;
+    uint64_t end = writeCount.load(std::memory_order_acquire);
+    uint64_t count = std::min<uint64_t>(end, std::min<uint64_t>(maxCount, kRingSize));
+
+    for (uint64_t index = end - count; index < end; index++) {
+        const RingSlot& slot = ring[index & (kRingSize - 1)];
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != index + 1) {
+            continue;   // 正在写入或已被覆盖
+        }
+
+        LogRecord record;
+        record.level = slot.level;
+        record.timestampNs = slot.timestampNs;
+        char text[kMessageSize];
+        std::memcpy(text, slot.text, kMessageSize);
+        text[kMessageSize - 1] = '\0';
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) {
+            continue;
+        }
+        record.message = text;
+        records.push_back(record);
+    }
+    return records;
+}
+
+const char* Logger::levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::TRACE: return "TRACE";
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO: return "INFO";
+        case LogLevel::WARN: return "WARN";
+        case LogLevel::ERR: return "ERROR";
+        default: return "OFF";
+    }
+}
+
+LogLevel Logger::levelFromName(const std::string& name, LogLevel defaultLevel) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    if (lower == "trace") return LogLevel::TRACE;
+    if (lower == "debug") return LogLevel::DEBUG;
+    if (lower == "info") return LogLevel::INFO;
+    if (lower == "warn" || lower == "warning") return LogLevel::WARN;
+    if (lower == "error") return LogLevel::ERR;
+    if (lower == "off") return LogLevel::OFF;
+    return defaultLevel;
+}
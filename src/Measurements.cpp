@@ -1,4 +1,6 @@
 #include "Measurements.h"
+#include "Logger.h"
+#include "Profiler.h"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
@@ -14,8 +16,8 @@ MeasurementResult Measurements::countObjects(const cv::Mat& image, int minSize,
     std::vector<std::vector<cv::Point>> contours = detectObjects(image, minSize, maxSize, sensitivity);
     MeasurementResult result = calculateStatistics(contours);
     
-    std::cout << "DEBUG: countObjects found " << result.objectCount << " objects with sensitivity=" 
-              << sensitivity << ", minSize=" << minSize << ", maxSize=" << maxSize << std::endl;
+    LOG_DEBUG("countObjects found " << result.objectCount << " objects with sensitivity=" 
+              << sensitivity << ", minSize=" << minSize << ", maxSize=" << maxSize);
     
     return result;
 }
@@ -24,16 +26,16 @@ MeasurementResult Measurements::countObjects(const cv::Mat& image, int minSize,
 std::vector<std::vector<cv::Point>> Measurements::detectObjects(const cv::Mat& image, int minSize, int maxSize, double sensitivity) {
     cv::Mat processedImage;
 
-    std::cout << "DEBUG: detectObjects input - size=" << image.size() << ", channels=" << image.channels() << std::endl;
+    LOG_DEBUG("detectObjects input - size=" << image.size() << ", channels=" << image.channels());
 
     // Use input image directly (assuming it's already processed by previous steps)
     if (image.channels() == 1) {
         processedImage = image.clone();
-        std::cout << "DEBUG: Using single-channel input directly for object detection" << std::endl;
+        LOG_DEBUG("Using single-channel input directly for object detection");
     } else if (image.channels() == 3) {
         // Convert to grayscale but don't apply additional processing
         cv::cvtColor(image, processedImage, cv::COLOR_BGR2GRAY);
-        std::cout << "DEBUG: Converted to grayscale for object detection" << std::endl;
+        LOG_DEBUG("Converted to grayscale for object detection");
     } else {
         processedImage = image.clone();
     }
@@ -42,7 +44,7 @@ std::vector<std::vector<cv::Point>> Measurements::detectObjects(const cv::Mat& i
     if (sensitivity < 0.8) {
         cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3, 3));
         cv::morphologyEx(processedImage, processedImage, cv::MORPH_OPEN, kernel);
-        std::cout << "DEBUG: Applied minimal morphological opening for noise reduction" << std::endl;
+        LOG_DEBUG("Applied minimal morphological opening for noise reduction");
     }
     
     // Find contours
@@ -142,6 +144,7 @@ cv::Mat Measurements::createVisualizationImage(const cv::Mat& image, const Measu
 
 // 统一的应用函数
 MeasurementResult Measurements::applyFunction(const cv::Mat& image, MeasurementsFunction function, const std::vector<double>& params) {
+    ScopedTimer timer("Measurements #" + std::to_string((int)function));
     switch (function) {
         case MeasurementsFunction::COUNT:
             return countObjects(image, 
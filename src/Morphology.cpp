@@ -1,4 +1,6 @@
 #include "Morphology.h"
+#include "Logger.h"
+#include "Profiler.h"
 #include <iostream>
 
 Morphology::Morphology() {
@@ -24,7 +26,7 @@ cv::Mat Morphology::dilate(const cv::Mat& image, int kernelSize, int kernelType)
     cv::Mat kernel = getKernel(kernelType, kernelSize);
     cv::dilate(image, result, kernel);
     
-    std::cout << "DEBUG: dilate applied with kernelSize=" << kernelSize << ", kernelType=" << kernelType << std::endl;
+    LOG_DEBUG("dilate applied with kernelSize=" << kernelSize << ", kernelType=" << kernelType);
     return result;
 }
 
@@ -33,7 +35,7 @@ cv::Mat Morphology::erode(const cv::Mat& image, int kernelSize, int kernelType)
     cv::Mat kernel = getKernel(kernelType, kernelSize);
     cv::erode(image, result, kernel);
     
-    std::cout << "DEBUG: erode applied with kernelSize=" << kernelSize << ", kernelType=" << kernelType << std::endl;
+    LOG_DEBUG("erode applied with kernelSize=" << kernelSize << ", kernelType=" << kernelType);
     return result;
 }
 
@@ -42,7 +44,7 @@ cv::Mat Morphology::opening(const cv::Mat& image, int kernelSize, int kernelType
     cv::Mat kernel = getKernel(kernelType, kernelSize);
     cv::morphologyEx(image, result, cv::MORPH_OPEN, kernel);
     
-    std::cout << "DEBUG: opening applied with kernelSize=" << kernelSize << ", kernelType=" << kernelType << std::endl;
+    LOG_DEBUG("opening applied with kernelSize=" << kernelSize << ", kernelType=" << kernelType);
     return result;
 }
 
@@ -51,7 +53,7 @@ cv::Mat Morphology::closing(const cv::Mat& image, int kernelSize, int kernelType
     cv::Mat kernel = getKernel(kernelType, kernelSize);
     cv::morphologyEx(image, result, cv::MORPH_CLOSE, kernel);
     
-    std::cout << "DEBUG: closing applied with kernelSize=" << kernelSize << ", kernelType=" << kernelType << std::endl;
+    LOG_DEBUG("closing applied with kernelSize=" << kernelSize << ", kernelType=" << kernelType);
     return result;
 }
 
@@ -60,7 +62,7 @@ cv::Mat Morphology::gradient(const cv::Mat& image, int kernelSize, int kernelTyp
     cv::Mat kernel = getKernel(kernelType, kernelSize);
     cv::morphologyEx(image, result, cv::MORPH_GRADIENT, kernel);
     
-    std::cout << "DEBUG: gradient applied with kernelSize=" << kernelSize << ", kernelType=" << kernelType << std::endl;
+    LOG_DEBUG("gradient applied with kernelSize=" << kernelSize << ", kernelType=" << kernelType);
     return result;
 }
 
@@ -69,7 +71,7 @@ cv::Mat Morphology::topHat(const cv::Mat& image, int kernelSize, int kernelType)
     cv::Mat kernel = getKernel(kernelType, kernelSize);
     cv::morphologyEx(image, result, cv::MORPH_TOPHAT, kernel);
     
-    std::cout << "DEBUG: topHat applied with kernelSize=" << kernelSize << ", kernelType=" << kernelType << std::endl;
+    LOG_DEBUG("topHat applied with kernelSize=" << kernelSize << ", kernelType=" << kernelType);
     return result;
 }
 
@@ -78,7 +80,7 @@ cv::Mat Morphology::blackHat(const cv::Mat& image, int kernelSize, int kernelTyp
     cv::Mat kernel = getKernel(kernelType, kernelSize);
     cv::morphologyEx(image, result, cv::MORPH_BLACKHAT, kernel);
     
-    std::cout << "DEBUG: blackHat applied with kernelSize=" << kernelSize << ", kernelType=" << kernelType << std::endl;
+    LOG_DEBUG("blackHat applied with kernelSize=" << kernelSize << ", kernelType=" << kernelType);
     return result;
 }
 
@@ -86,7 +88,7 @@ cv::Mat Morphology::separateFeatures(const cv::Mat& image, double edgeThreshold,
     cv::Mat result;
     cv::Mat grayImage;
 
-    std::cout << "DEBUG: separateFeatures input - size=" << image.size() << ", channels=" << image.channels() << std::endl;
+    LOG_DEBUG("separateFeatures input - size=" << image.size() << ", channels=" << image.channels());
 
     // Use input image directly (assuming it's already in the correct format)
     if (image.channels() == 1) {
@@ -146,14 +148,15 @@ cv::Mat Morphology::separateFeatures(const cv::Mat& image, double edgeThreshold,
         cv::fillPoly(result, contours, color);
     }
 
-    std::cout << "DEBUG: separateFeatures applied with edgeThreshold=" << edgeThreshold
+    LOG_DEBUG("separateFeatures applied with edgeThreshold=" << edgeThreshold
               << ", separationMethod=" << separationMethod << ", kernelSize=" << kernelSize
-              << ", found " << contours.size() << " features" << std::endl;
+              << ", found " << contours.size() << " features");
     return result;
 }
 
 // 统一的应用函数
 cv::Mat Morphology::applyFunction(const cv::Mat& image, MorphologyFunction function, const std::vector<double>& params) {
+    ScopedTimer timer("Morphology #" + std::to_string((int)function));
     int kernelSize = params.size() > 0 ? (int)params[0] : 5;
     int kernelType = params.size() > 1 ? (int)params[1] : 1; // Default to ELLIPSE
     
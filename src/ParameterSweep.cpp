@@ -0,0 +1,184 @@
+#include "ParameterSweep.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "ProxyPyramid.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace {
+
+// 格子之间的间隔
+const int kCellGap = 2;
+
+int gridColumns(int count) {
+    return std::max(1, (int)std::ceil(std::sqrt((double)count)));
+}
+
+}
+
+bool ParameterSweep::defaultRange(const PipelineStep& step, SweepRange& range) {
+    switch (step.module) {
+        case PipelineModule::SEGMENTATION:
+            switch ((SegmentationFunction)step.function) {
+                case SegmentationFunction::BASIC_THRESHOLD:
+                    range.paramIndex = 0;
+                    range.from = 0;
+                    range.to = 255;
+                    range.oddInteger = false;
+                    range.label = "T";
+                    return true;
+                case SegmentationFunction::RANGE_THRESHOLD:
+                    range.paramIndex = 0;
+                    range.from = 0;
+                    range.to = 255;
+                    range.oddInteger = false;
+                    range.label = "Min";
+                    return true;
+                case SegmentationFunction::ADAPTIVE_THRESHOLD:
+                    range.paramIndex = 2;
+                    range.from = 3;
+                    range.to = 33;
+                    range.oddInteger = true;
+                    range.label = "Block";
+                    return true;
+                default:
+                    return false;
+            }
+        case PipelineModule::MORPHOLOGY:
+            range.paramIndex = 0;
+            range.from = 3;
+            range.to = 31;
+            range.oddInteger = true;
+            range.label = "k";
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::vector<double> ParameterSweep::values(const SweepRange& range, int count) {
+    std::vector<double> result;
+    if (count <= 0) {
+        return result;
+    }
+
+    for (int i = 0; i < count; i++) {
+        double t = count > 1 ? (double)i / (count - 1) : 0.0;
+        double value = range.from + (range.to - range.from) * t;
+        if (range.oddInteger) {
+            value = (double)((int)std::lround(value) | 1);
+        } else {
+            value = std::round(value);
+        }
+        if (result.empty() || value != result.back()) {
+            result.push_back(value);
+        }
+    }
+    return result;
+}
+
+std::vector<SweepCell> ParameterSweep::run(const cv::Mat& image, const PipelineStep& step, int paramIndex,
+                                           const std::vector<double>& values, double scale, const cv::Size& cellSize) {
+    ScopedTimer timer("Sweep " + Pipeline::timerName(step));
+    std::vector<SweepCell> cells(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        cells[i].value = values[i];
+    }
+    if (image.empty() || values.empty() || paramIndex < 0) {
+        return cells;
+    }
+
+    // 共享的中间结果：分割函数和特征分离都先转为灰度，这里只转换一次
+    bool grayInput = step.module == PipelineModule::SEGMENTATION ||
+                     (step.module == PipelineModule::MORPHOLOGY &&
+                      (MorphologyFunction)step.function == MorphologyFunction::SEPARATE_FEATURES);
+    cv::Mat input = image;
+    if (grayInput && image.channels() == 3) {
+        cv::cvtColor(image, input, cv::COLOR_BGR2GRAY);
+    }
+
+    PipelineStep base = step;
+    if ((int)base.params.size() <= paramIndex) {
+        LOG_WARN("Sweep of " << Pipeline::describeStep(step) << ": parameter " << paramIndex << " is not set");
+        return cells;
+    }
+
+    // 每格一个条带；格子之间通过OpenCV线程池并行，不修改全局线程设置；格子内部的OpenCV调用处于并行区域内，自动串行执行
+    cv::parallel_for_(cv::Range(0, (int)values.size()), [&](const cv::Range& range) {
+        for (int index = range.start; index < range.end; index++) {
+            SweepCell& cell = cells[index];
+            try {
+                PipelineStep cellStep = base;
+                cellStep.params[paramIndex] = values[index];
+                cv::Mat output = Pipeline::applyStep(input, ProxyPyramid::scaleStep(cellStep, scale));
+                if (output.empty()) {
+                    continue;
+                }
+
+                double fit = std::min(1.0, std::min((double)cellSize.width / output.cols, (double)cellSize.height / output.rows));
+                cv::Mat thumbnail = output;
+                if (fit < 1.0) {
+                    cv::resize(output, thumbnail, cv::Size(std::max(1, (int)(output.cols * fit)), std::max(1, (int)(output.rows * fit))),
+                               0, 0, cv::INTER_AREA);
+                }
+                if (thumbnail.channels() == 1) {
+                    cv::cvtColor(thumbnail, cell.thumbnail, cv::COLOR_GRAY2BGR);
+                } else {
+                    cell.thumbnail = thumbnail;
+                }
+            } catch (const std::exception& e) {
+                LOG_WARN("Sweep value " << values[index] << " failed: " << e.what());
+            }
+        }
+    }, (double)values.size());
+
+    LOG_DEBUG("Sweep of " << Pipeline::describeStep(step) << ": " << values.size() << " values on "
+              << input.cols << "x" << input.rows);
+    return cells;
+}
+
+cv::Rect ParameterSweep::cellRect(int index, int count, const cv::Size& gridSize) {
+    int columns = gridColumns(count);
+    int rows = std::max(1, (count + columns - 1) / columns);
+    int cellWidth = std::max(1, (gridSize.width - kCellGap * (columns - 1)) / columns);
+    int cellHeight = std::max(1, (gridSize.height - kCellGap * (rows - 1)) / rows);
+    return cv::Rect((index % columns) * (cellWidth + kCellGap), (index / columns) * (cellHeight + kCellGap),
+                    cellWidth, cellHeight);
+}
+
+cv::Mat ParameterSweep::composeGrid(const std::vector<SweepCell>& cells, const SweepRange& range, const cv::Size& gridSize) {
+    cv::Mat grid(gridSize, CV_8UC3, cv::Scalar(49, 52, 49));
+    int count = (int)cells.size();
+
+    for (int i = 0; i < count; i++) {
+        cv::Rect cell = cellRect(i, count, gridSize);
+        const cv::Mat& thumbnail = cells[i].thumbnail;
+        if (!thumbnail.empty()) {
+            cv::Mat fitted = thumbnail;
+            if (thumbnail.cols > cell.width || thumbnail.rows > cell.height) {
+                double fit = std::min((double)cell.width / thumbnail.cols, (double)cell.height / thumbnail.rows);
+                cv::resize(thumbnail, fitted, cv::Size(std::max(1, (int)(thumbnail.cols * fit)), std::max(1, (int)(thumbnail.rows * fit))),
+                           0, 0, cv::INTER_AREA);
+            }
+            cv::Rect target(cell.x + (cell.width - fitted.cols) / 2, cell.y + (cell.height - fitted.rows) / 2,
+                            fitted.cols, fitted.rows);
+            fitted.copyTo(grid(target));
+        }
+
+        // 参数值标注在格子底部
+        std::string label = cellLabel(range, cells[i].value);
+        cv::Rect strip(cell.x, cell.y + cell.height - 14, cell.width, 14);
+        strip &= cv::Rect(cv::Point(), gridSize);
+        grid(strip) = cv::Scalar(30, 30, 30);
+        cv::putText(grid, label, cv::Point(cell.x + 3, cell.y + cell.height - 3), cv::FONT_HERSHEY_SIMPLEX, 0.35,
+                    cv::Scalar(255, 255, 255), 1, cv::LINE_AA);
+    }
+    return grid;
+}
+
+std::string ParameterSweep::cellLabel(const SweepRange& range, double value) {
+    std::stringstream ss;
+    ss << range.label << "=" << value;
+    return ss.str();
+}
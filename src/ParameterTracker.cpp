@@ -0,0 +1,83 @@
+#include "ParameterTracker.h"
+#include "Logger.h"
+#include <algorithm>
+
+// 约一帧（主循环活动时15 ms轮询一次）
+const double ParameterTracker::kDefaultInstantMs = 15.0;
+const double ParameterTracker::kDefaultMaxIntervalMs = 500.0;
+
+ParameterTracker::ParameterTracker()
+    : instantMs(kDefaultInstantMs), maxIntervalMs(kDefaultMaxIntervalMs),
+      hasSubmitted(false), pending(false), forced(false) {
+}
+
+void ParameterTracker::setPolicy(double instantMs, double maxIntervalMs) {
+    this->instantMs = std::max(0.0, instantMs);
+    this->maxIntervalMs = std::max(this->instantMs, maxIntervalMs);
+}
+
+void ParameterTracker::setInterval(const std::string& timerName, double intervalMs) {
+    intervals[timerName] = std::max(0.0, intervalMs);
+}
+
+bool ParameterTracker::observe(const PipelineStep& step, double costMs, Clock::time_point now) {
+    if (step.module == PipelineModule::NONE) {
+        reset();
+        return false;
+    }
+
+    bool changed = !hasSubmitted || !sameFunction(step, submitted) || step.params != submitted.params;
+    pending = changed;
+    if (!changed && !forced) {
+        return false;
+    }
+
+    // 新函数和显式请求立即计算，参数变化按间隔合并
+    bool immediate = forced || !hasSubmitted || !sameFunction(step, submitted);
+    if (!immediate) {
+        double elapsedMs = std::chrono::duration<double, std::milli>(now - submittedAt).count();
+        double intervalMs = intervalFor(step, costMs);
+        if (elapsedMs < intervalMs) {
+            return false;
+        }
+    }
+
+    hasSubmitted = true;
+    submitted = step;
+    submittedAt = now;
+    pending = false;
+    forced = false;
+    LOG_TRACE("Preview parameters submitted: " << Pipeline::describeStep(step));
+    return true;
+}
+
+void ParameterTracker::requestUpdate() {
+    forced = true;
+}
+
+bool ParameterTracker::hasPending() const {
+    return pending || forced;
+}
+
+void ParameterTracker::reset() {
+    hasSubmitted = false;
+    submitted = PipelineStep();
+    pending = false;
+    forced = false;
+}
+
+double ParameterTracker::intervalFor(const PipelineStep& step, double costMs) const {
+    auto found = intervals.find(Pipeline::timerName(step));
+    if (found != intervals.end()) {
+        return found->second;
+    }
+    if (costMs <= instantMs) {
+        return 0.0;
+    }
+    // 间隔与后台线程的吞吐量相当，计算完成前不再提交新的参数
+    return std::min(costMs, maxIntervalMs);
+}
+
+bool ParameterTracker::sameFunction(const PipelineStep& a, const PipelineStep& b) {
+    return a.module == b.module && a.function == b.function;
+}
@@ -0,0 +1,209 @@
+#include "Pipeline.h"
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// 各模块功能枚举的取值范围，配方中超出范围的功能在加载时拒绝，而不是在执行时被静默跳过
+bool isKnownFunction(PipelineModule module, int function) {
+    if (function < 0) {
+        return false;
+    }
+    switch (module) {
+        case PipelineModule::PRE_PROCESSING:
+            return function <= (int)PreProcessingFunction::GRAYSCALE_RECONSTRUCTION;
+        case PipelineModule::SEGMENTATION:
+            return function <= (int)SegmentationFunction::LOCAL_THRESHOLD;
+        case PipelineModule::MORPHOLOGY:
+            return function <= (int)MorphologyFunction::SEPARATE_FEATURES;
+        case PipelineModule::CLEAN_UP:
+            return function <= (int)CleanUpFunction::REJECT_FEATURES;
+        case PipelineModule::MEASUREMENTS:
+            return function <= (int)MeasurementsFunction::COUNT;
+        case PipelineModule::COLOR:
+            return function <= (int)ColorFunction::CHANNEL_OPERATION;
+        default:
+            return false;
+    }
+}
+
+}
+
+Pipeline::Pipeline() {
+}
+
+Pipeline::~Pipeline() {
+}
+
+bool Pipeline::loadFromFile(const std::string& path) {
+    cv::FileStorage fs;
+    try {
+        if (!fs.open(path, cv::FileStorage::READ)) {
+            std::cout << "Failed to open pipeline file: " << path << std::endl;
+            return false;
+        }
+    } catch (const cv::Exception& e) {
+        std::cout << "Failed to parse pipeline file: " << path << " (" << e.what() << ")" << std::endl;
+        return false;
+    }
+
+    cv::FileNode stepsNode = fs["steps"];
+    if (stepsNode.type() != cv::FileNode::SEQ) {
+        std::cout << "Pipeline file has no 'steps' sequence: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<PipelineStep> loadedSteps;
+    for (cv::FileNodeIterator it = stepsNode.begin(); it != stepsNode.end(); ++it) {
+        cv::FileNode node = *it;
+        size_t index = loadedSteps.size() + 1;
+
+        std::string moduleText;
+        node["module"] >> moduleText;
+        PipelineStep step;
+        step.module = moduleFromName(moduleText);
+        if (step.module == PipelineModule::NONE) {
+            std::cout << "Unknown pipeline module '" << moduleText << "' in step " << index << " of " << path << std::endl;
+            return false;
+        }
+
+        cv::FileNode functionNode = node["function"];
+        if (!functionNode.isInt()) {
+            std::cout << "Missing or non-integer function in step " << index << " of " << path << std::endl;
+            return false;
+        }
+        functionNode >> step.function;
+        if (!isKnownFunction(step.module, step.function)) {
+            std::cout << "Unknown " << moduleText << " function " << step.function << " in step " << index
+                      << " of " << path << std::endl;
+            return false;
+        }
+        if (!node["params"].empty()) {
+            node["params"] >> step.params;
+        }
+        loadedSteps.push_back(step);
+    }
+
+    steps = loadedSteps;
+    std::cout << "Loaded pipeline with " << steps.size() << " steps from " << path << std::endl;
+    return true;
+}
+
+bool Pipeline::saveToFile(const std::string& path) const {
+    cv::FileStorage fs;
+    try {
+        if (!fs.open(path, cv::FileStorage::WRITE)) {
+            std::cout << "Failed to open pipeline file for writing: " << path << std::endl;
+            return false;
+        }
+    } catch (const cv::Exception& e) {
+        std::cout << "Failed to write pipeline file: " << path << " (" << e.what() << ")" << std::endl;
+        return false;
+    }
+
+    fs << "steps" << "[";
+    for (const PipelineStep& step : steps) {
+        fs << "{";
+        fs << "module" << moduleName(step.module);
+        fs << "function" << step.function;
+        fs << "params" << step.params;
+        fs << "}";
+    }
+    fs << "]";
+    fs.release();
+
+    std::cout << "Saved pipeline with " << steps.size() << " steps to " << path << std::endl;
+    return true;
+}
+
+void Pipeline::addStep(const PipelineStep& step) {
+    steps.push_back(step);
+}
+
+void Pipeline::clear() {
+    steps.clear();
+}
+
+bool Pipeline::empty() const {
+    return steps.empty();
+}
+
+const std::vector<PipelineStep>& Pipeline::getSteps() const {
+    return steps;
+}
+
+cv::Mat Pipeline::run(const cv::Mat& image, std::vector<MeasurementResult>* measurements) const {
+    cv::Mat current = image;
+    for (const PipelineStep& step : steps) {
+        MeasurementResult measurement;
+        current = applyStep(current, step, &measurement);
+        if (measurements && step.module == PipelineModule::MEASUREMENTS) {
+            measurements->push_back(measurement);
+        }
+    }
+    return current;
+}
+
+cv::Mat Pipeline::applyStep(const cv::Mat& image, const PipelineStep& step, MeasurementResult* measurement) {
+    switch (step.module) {
+        case PipelineModule::PRE_PROCESSING:
+            return PreProcessing::applyFunction(image, static_cast<PreProcessingFunction>(step.function), step.params);
+        case PipelineModule::SEGMENTATION:
+            return Segmentation::applyFunction(image, static_cast<SegmentationFunction>(step.function), step.params);
+        case PipelineModule::MORPHOLOGY:
+            return Morphology::applyFunction(image, static_cast<MorphologyFunction>(step.function), step.params);
+        case PipelineModule::CLEAN_UP:
+            return CleanUp::applyFunction(image, static_cast<CleanUpFunction>(step.function), step.params);
+        case PipelineModule::COLOR:
+            return ColorProcessing::applyFunction(image, static_cast<ColorFunction>(step.function), step.params);
+        case PipelineModule::MEASUREMENTS:
+            {
+                MeasurementResult result = Measurements::applyFunction(image, static_cast<MeasurementsFunction>(step.function), step.params);
+                if (measurement) {
+                    *measurement = result;
+                }
+                // 与界面一致：测量步骤输出带标注的可视化图像
+                int minSize = step.params.size() > 0 ? static_cast<int>(step.params[0]) : 10;
+                int maxSize = step.params.size() > 1 ? static_cast<int>(step.params[1]) : 10000;
+                return Measurements::createVisualizationImage(image, result, minSize, maxSize);
+            }
+        default:
+            return image;
+    }
+}
+
+const char* Pipeline::moduleName(PipelineModule module) {
+    switch (module) {
+        case PipelineModule::PRE_PROCESSING: return "PreProcessing";
+        case PipelineModule::SEGMENTATION: return "Segmentation";
+        case PipelineModule::MORPHOLOGY: return "Morphology";
+        case PipelineModule::CLEAN_UP: return "CleanUp";
+        case PipelineModule::MEASUREMENTS: return "Measurements";
+        case PipelineModule::COLOR: return "Color";
+        default: return "None";
+    }
+}
+
+PipelineModule Pipeline::moduleFromName(const std::string& name) {
+    if (name == "PreProcessing") return PipelineModule::PRE_PROCESSING;
+    if (name == "Segmentation") return PipelineModule::SEGMENTATION;
+    if (name == "Morphology") return PipelineModule::MORPHOLOGY;
+    if (name == "CleanUp") return PipelineModule::CLEAN_UP;
+    if (name == "Measurements") return PipelineModule::MEASUREMENTS;
+    if (name == "Color") return PipelineModule::COLOR;
+    return PipelineModule::NONE;
+}
+
+std::string Pipeline::describeStep(const PipelineStep& step) {
+    std::stringstream ss;
+    ss << moduleName(step.module) << " #" << step.function << " [";
+    for (size_t i = 0; i < step.params.size(); i++) {
+        ss << (i > 0 ? ", " : "") << step.params[i];
+    }
+    ss << "]";
+    return ss.str();
+}
+
+std::string Pipeline::timerName(const PipelineStep& step) {
+    return std::string(moduleName(step.module)) + " #" + std::to_string(step.function);
+}
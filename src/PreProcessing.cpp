@@ -1,6 +1,37 @@
 #include "PreProcessing.h"
+#include "FilterKernels.h"
+#include "FrequencyFilter.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
+namespace {
+
+// 8位图像的核达到该大小时改用滑动直方图中值滤波；更小的核cv::medianBlur的排序网络更快
+const int kHistogramMedianKernel = 15;
+
+// 两个方向的σ都达到该值时改用递归高斯：此时±4σ的FIR核已超过80个抽头，而递归的每像素开销是固定的
+const double kRecursiveGaussianSigma = 10.0;
+
+// 与cv::GaussianBlur相同：σ不大于0时由核大小推算
+double effectiveSigma(int kernelSize, double sigma) {
+    return sigma > 0 ? sigma : 0.3 * ((kernelSize - 1) * 0.5 - 1) + 0.8;
+}
+
+// 显式给出的核短于±3σ时FIR结果已被明显截断，递归高斯无法再现，仍使用FIR
+bool coversKernel(int kernelSize, double sigma) {
+    return kernelSize <= 0 || kernelSize >= 2 * (int)std::ceil(3 * sigma) + 1;
+}
+
+// 窗口滤波只支持奇数核；旧配方和参数扫描中的偶数核向上取为奇数，不小于1
+int oddKernelSize(int kernelSize) {
+    return std::max(1, kernelSize) | 1;
+}
+
+}
+
 PreProcessing::PreProcessing() {
 }
 
@@ -11,8 +42,8 @@ PreProcessing::~PreProcessing() {
 cv::Mat PreProcessing::adjustContrast(const cv::Mat& image, double brightness, double contrast) {
     cv::Mat result;
     image.convertTo(result, image.type(), contrast, brightness);
-    std::cout << "DEBUG: PreProcessing::adjustContrast - input: " << image.cols << "x" << image.rows 
-              << ", output: " << result.cols << "x" << result.rows << std::endl;
+    LOG_DEBUG("PreProcessing::adjustContrast - input: " << image.cols << "x" << image.rows 
+              << ", output: " << result.cols << "x" << result.rows);
     return result;
 }
 
@@ -60,16 +91,18 @@ cv::Mat PreProcessing::flattenBackground(const cv::Mat& image, int kernelSize) {
 
 // NOISE-REDUCTION类别算法实现
 cv::Mat PreProcessing::medianFilter(const cv::Mat& image, int kernelSize) {
+    if (image.depth() == CV_8U && kernelSize % 2 == 1 && kernelSize >= kHistogramMedianKernel &&
+        kernelSize <= FilterKernels::kMaxMedianKernel) {
+        return FilterKernels::median8u(image, kernelSize);
+    }
     cv::Mat result;
     cv::medianBlur(image, result, kernelSize);
     return result;
 }
 
-cv::Mat PreProcessing::wienerFilter(const cv::Mat& image, int kernelSize) {
-    // 简化的Wiener滤波实现 - 使用双边滤波近似
-    cv::Mat result;
-    cv::bilateralFilter(image, result, kernelSize, kernelSize * 2, kernelSize / 2);
-    return result;
+cv::Mat PreProcessing::wienerFilter(const cv::Mat& image, int kernelSize, double noiseVariance) {
+    // 局部均值/方差的自适应Wiener滤波，每像素开销与核大小无关
+    return FilterKernels::wiener(image, oddKernelSize(kernelSize), noiseVariance);
 }
 
 cv::Mat PreProcessing::nonLocalMeans(const cv::Mat& image, double h, int templateWindowSize, int searchWindowSize) {
@@ -83,7 +116,21 @@ cv::Mat PreProcessing::nonLocalMeans(const cv::Mat& image, double h, int templat
 }
 
 // BLUR类别算法实现
+bool PreProcessing::usesRecursiveGaussian(int kernelSize, double sigmaX, double sigmaY, double& sx, double& sy) {
+    if (kernelSize <= 0 && sigmaX <= 0) {
+        return false;
+    }
+    sx = effectiveSigma(kernelSize, sigmaX);
+    sy = sigmaY > 0 ? sigmaY : sx;
+    return std::min(sx, sy) >= kRecursiveGaussianSigma && coversKernel(kernelSize, std::max(sx, sy));
+}
+
 cv::Mat PreProcessing::gaussianBlur(const cv::Mat& image, int kernelSize, double sigmaX, double sigmaY) {
+    double sx, sy;
+    if (usesRecursiveGaussian(kernelSize, sigmaX, sigmaY, sx, sy)) {
+        return FilterKernels::recursiveGaussian(image, sx, sy);
+    }
+
     cv::Mat result;
     cv::GaussianBlur(image, result, cv::Size(kernelSize, kernelSize), sigmaX, sigmaY);
     return result;
@@ -95,11 +142,9 @@ cv::Mat PreProcessing::averageBlur(const cv::Mat& image, int kernelSize) {
     return result;
 }
 
-cv::Mat PreProcessing::sumFilter(const cv::Mat& image, int kernelSize) {
-    cv::Mat result;
-    cv::Mat kernel = cv::Mat::ones(kernelSize, kernelSize, CV_32F);
-    cv::filter2D(image, result, -1, kernel);
-    return result;
+cv::Mat PreProcessing::sumFilter(const cv::Mat& image, int kernelSize, int ddepth, double scale) {
+    // 8位输出会在窗口和超过255时饱和，因此默认输出32位
+    return FilterKernels::boxSum(image, oddKernelSize(kernelSize), ddepth, scale);
 }
 
 cv::Mat PreProcessing::grayscaleDilate(const cv::Mat& image, int kernelSize) {
@@ -118,21 +163,53 @@ cv::Mat PreProcessing::grayscaleErode(const cv::Mat& image, int kernelSize) {
 
 // EDGES类别算法实现
 cv::Mat PreProcessing::stdDevFilter(const cv::Mat& image, int kernelSize) {
-    cv::Mat result;
-    cv::Mat mean, sqrMean;
-    cv::blur(image, mean, cv::Size(kernelSize, kernelSize));
-    cv::Mat squared;
-    cv::multiply(image, image, squared);
-    cv::blur(squared, sqrMean, cv::Size(kernelSize, kernelSize));
-    cv::Mat meanSquared;
-    cv::multiply(mean, mean, meanSquared);
-    cv::sqrt(sqrMean - meanSquared, result);
-    return result;
+    // 整数图像输出8位，按输入的满量程归一化（8位输入不缩放）；浮点图像输出CV_32F
+    int k = oddKernelSize(kernelSize);
+    switch (image.depth()) {
+        case CV_8U:
+        case CV_8S:
+            return FilterKernels::localStdDev(image, k, CV_8U, 1.0);
+        case CV_16U:
+        case CV_16S:
+            return FilterKernels::localStdDev(image, k, CV_8U, 255.0 / 65535.0);
+        case CV_32S:
+            return FilterKernels::localStdDev(image, k, CV_8U, 255.0 / 4294967295.0);
+        default:
+            return FilterKernels::localStdDev(image, k, CV_32F, 1.0);
+    }
 }
 
 cv::Mat PreProcessing::entropyFilter(const cv::Mat& image, int kernelSize) {
-    // 简化的熵滤波实现 - 使用局部标准差近似
-    return stdDevFilter(image, kernelSize);
+    // 熵按256个灰度桶统计，非8位图像按位深的固定范围映射到0~255，不依赖图像内容，
+    // 因此分块处理和局部预览与整幅处理的结果一致。浮点图像按0~255的灰度单位饱和截断
+    cv::Mat image8u = image;
+    switch (image.depth()) {
+        case CV_8U:
+            break;
+        case CV_8S:
+            image.convertTo(image8u, CV_8U, 1.0, 128.0);
+            break;
+        case CV_16U:
+            image.convertTo(image8u, CV_8U, 1.0 / 257.0);
+            break;
+        case CV_16S:
+            image.convertTo(image8u, CV_8U, 1.0 / 257.0, 32768.0 / 257.0);
+            break;
+        case CV_32S:
+            image.convertTo(image8u, CV_8U, 1.0 / 16843009.0, 2147483648.0 / 16843009.0);
+            break;
+        default:
+            image.convertTo(image8u, CV_8U);
+            break;
+    }
+
+    // 输出8位，窗口内能达到的最大熵对应255
+    int k = oddKernelSize(kernelSize);
+    cv::Mat entropy = FilterKernels::entropy8u(image8u, k);
+    double maxEntropy = std::log2((double)std::min(k * k, 256));
+    cv::Mat result;
+    entropy.convertTo(result, CV_8U, maxEntropy > 0 ? 255.0 / maxEntropy : 0.0);
+    return result;
 }
 
 cv::Mat PreProcessing::gradientFilter(const cv::Mat& image) {
@@ -212,11 +289,20 @@ cv::Mat PreProcessing::sharpen(const cv::Mat& image, double strength) {
     return result;
 }
 
-cv::Mat PreProcessing::fftFilter(const cv::Mat& image) {
-    // 简化的FFT滤波 - 使用高斯低通滤波近似
-    cv::Mat result;
-    cv::GaussianBlur(image, result, cv::Size(15, 15), 2.0, 2.0);
-    return result;
+cv::Mat PreProcessing::fftFilter(const cv::Mat& image, int maskType, double cutoff, double upperCutoff,
+                                 double notchX, double notchY, FrequencyFilter* cache) {
+    FrequencyMask mask;
+    mask.type = (FrequencyMaskType)std::max(0, std::min(maskType, (int)FrequencyMaskType::NOTCH));
+    mask.cutoff = cutoff;
+    mask.upperCutoff = upperCutoff;
+    mask.notchX = notchX;
+    mask.notchY = notchY;
+    if (cache) {
+        return cache->apply(image, mask);
+    }
+    // 不缓存：频谱随局部对象一起释放
+    FrequencyFilter filter;
+    return filter.apply(image, mask);
 }
 
 cv::Mat PreProcessing::grayscaleInterpolation(const cv::Mat& image) {
@@ -237,6 +323,7 @@ cv::Mat PreProcessing::grayscaleReconstruction(const cv::Mat& image) {
 
 // 统一的应用函数
 cv::Mat PreProcessing::applyFunction(const cv::Mat& image, PreProcessingFunction function, const std::vector<double>& params) {
+    ScopedTimer timer("PreProcessing #" + std::to_string((int)function));
     switch (function) {
         case PreProcessingFunction::ADJUST_CONTRAST:
             return adjustContrast(image, params.size() > 0 ? params[0] : 0.0, params.size() > 1 ? params[1] : 1.0);
@@ -247,7 +334,7 @@ cv::Mat PreProcessing::applyFunction(const cv::Mat& image, PreProcessingFunction
         case PreProcessingFunction::MEDIAN_FILTER:
             return medianFilter(image, params.size() > 0 ? (int)params[0] : 5);
         case PreProcessingFunction::WIENER_FILTER:
-            return wienerFilter(image, params.size() > 0 ? (int)params[0] : 5);
+            return wienerFilter(image, params.size() > 0 ? (int)params[0] : 5, params.size() > 1 ? params[1] : 0.0);
         case PreProcessingFunction::NON_LOCAL_MEANS:
             return nonLocalMeans(image, params.size() > 0 ? params[0] : 10.0,
                                params.size() > 1 ? (int)params[1] : 7, params.size() > 2 ? (int)params[2] : 21);
@@ -257,7 +344,9 @@ cv::Mat PreProcessing::applyFunction(const cv::Mat& image, PreProcessingFunction
         case PreProcessingFunction::AVERAGE_BLUR:
             return averageBlur(image, params.size() > 0 ? (int)params[0] : 5);
         case PreProcessingFunction::SUM_FILTER:
-            return sumFilter(image, params.size() > 0 ? (int)params[0] : 5);
+            return sumFilter(image, params.size() > 0 ? (int)params[0] : 5,
+                             params.size() < 2 || params[1] < 0 ? -1 : (params[1] > 0 ? CV_32S : CV_32F),
+                             params.size() > 2 ? params[2] : 1.0);
         case PreProcessingFunction::GRAYSCALE_DILATE:
             return grayscaleDilate(image, params.size() > 0 ? (int)params[0] : 5);
         case PreProcessingFunction::GRAYSCALE_ERODE:
@@ -281,7 +370,9 @@ cv::Mat PreProcessing::applyFunction(const cv::Mat& image, PreProcessingFunction
         case PreProcessingFunction::SHARPEN:
             return sharpen(image, params.size() > 0 ? params[0] : 1.0);
         case PreProcessingFunction::FFT_FILTER:
-            return fftFilter(image);
+            return fftFilter(image, params.size() > 0 ? (int)params[0] : 0, params.size() > 1 ? params[1] : 0.16,
+                             params.size() > 2 ? params[2] : 0.5, params.size() > 3 ? params[3] : 0.5,
+                             params.size() > 4 ? params[4] : 0.0);
         case PreProcessingFunction::GRAYSCALE_INTERPOLATION:
             return grayscaleInterpolation(image);
         case PreProcessingFunction::GRAYSCALE_RECONSTRUCTION:
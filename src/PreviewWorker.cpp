@@ -0,0 +1,87 @@
+#include "PreviewWorker.h"
+#include "Logger.h"
+
+PreviewWorker::PreviewWorker()
+    : latestGeneration(0), pendingGeneration(0), running(false), stopping(false), hasFinishedResult(false) {
+    thread = std::thread(&PreviewWorker::workerLoop, this);
+}
+
+PreviewWorker::~PreviewWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        pendingJob = nullptr;
+    }
+    wakeUp.notify_one();
+    thread.join();
+}
+
+void PreviewWorker::submit(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingJob = std::move(job);
+        pendingGeneration = ++latestGeneration;
+    }
+    wakeUp.notify_one();
+}
+
+void PreviewWorker::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingJob = nullptr;
+    latestGeneration++;
+    hasFinishedResult = false;
+    finishedResult = PreviewResult();
+}
+
+bool PreviewWorker::takeResult(PreviewResult& result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!hasFinishedResult) {
+        return false;
+    }
+    result = std::move(finishedResult);
+    finishedResult = PreviewResult();
+    hasFinishedResult = false;
+    return true;
+}
+
+bool PreviewWorker::isBusy() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return running || pendingJob != nullptr;
+}
+
+void PreviewWorker::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeUp.wait(lock, [this]() { return stopping || pendingJob != nullptr; });
+        if (stopping) {
+            break;
+        }
+
+        Job job = std::move(pendingJob);
+        pendingJob = nullptr;
+        uint64_t generation = pendingGeneration;
+        running = true;
+        lock.unlock();
+
+        PreviewResult result;
+        bool failed = false;
+        try {
+            result = job();
+        } catch (const std::exception& e) {
+            LOG_WARN("Preview computation failed: " << e.what());
+            failed = true;
+        }
+
+        lock.lock();
+        running = false;
+        if (failed) {
+            continue;
+        }
+        if (generation == latestGeneration) {
+            finishedResult = std::move(result);
+            hasFinishedResult = true;
+        } else {
+            LOG_DEBUG("Discarded stale preview " << generation << " (latest " << latestGeneration << ")");
+        }
+    }
+}
@@ -0,0 +1,170 @@
+#include "Profiler.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+
+const double LatencyHistogram::kMinMs = 0.001;
+
+LatencyHistogram::LatencyHistogram() : buckets(kBucketCount, 0), total(0) {
+}
+
+void LatencyHistogram::add(double ms) {
+    int bucket;
+    if (ms < kMinMs) {
+        bucket = 0;
+    } else {
+        bucket = 1 + (int)std::floor(std::log10(ms / kMinMs) * kBucketsPerDecade);
+        bucket = std::min(bucket, kBucketCount - 1);
+    }
+    buckets[bucket]++;
+    total++;
+}
+
+size_t LatencyHistogram::count() const {
+    return total;
+}
+
+double LatencyHistogram::bucketUpperMs(int bucket) {
+    if (bucket >= kBucketCount - 1) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return kMinMs * std::pow(10.0, (double)bucket / kBucketsPerDecade);
+}
+
+double LatencyHistogram::percentile(double quantile) const {
+    if (total == 0) {
+        return 0;
+    }
+    size_t target = (size_t)std::ceil(quantile * total);
+    target = std::max<size_t>(1, std::min(target, total));
+
+    size_t cumulative = 0;
+    for (int bucket = 0; bucket < kBucketCount; bucket++) {
+        cumulative += buckets[bucket];
+        if (cumulative >= target) {
+            if (bucket == 0) {
+                return kMinMs;
+            }
+            if (bucket == kBucketCount - 1) {
+                return bucketUpperMs(bucket - 1);
+            }
+            // 取桶的几何中点
+            return std::sqrt(bucketUpperMs(bucket - 1) * bucketUpperMs(bucket));
+        }
+    }
+    return bucketUpperMs(kBucketCount - 2);
+}
+
+const std::vector<size_t>& LatencyHistogram::bucketCounts() const {
+    return buckets;
+}
+
+namespace {
+
+struct TimingEntry {
+    LatencyHistogram histogram;
+    double lastMs = 0;
+    double sumMs = 0;
+    double minMs = std::numeric_limits<double>::max();
+    double maxMs = 0;
+};
+
+std::mutex profilerMutex;
+std::map<std::string, TimingEntry> entries;
+
+TimingStats makeStats(const std::string& name, const TimingEntry& entry) {
+    TimingStats stats;
+    stats.name = name;
+    stats.count = entry.histogram.count();
+    stats.lastMs = entry.lastMs;
+    stats.meanMs = stats.count > 0 ? entry.sumMs / stats.count : 0;
+    stats.minMs = stats.count > 0 ? entry.minMs : 0;
+    stats.maxMs = entry.maxMs;
+    // 直方图只给出桶内的近似值，用实际的最小/最大值限制
+    stats.p50Ms = std::min(std::max(entry.histogram.percentile(0.50), stats.minMs), stats.maxMs);
+    stats.p95Ms = std::min(std::max(entry.histogram.percentile(0.95), stats.minMs), stats.maxMs);
+    return stats;
+}
+
+}
+
+void Profiler::record(const std::string& name, double ms) {
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    TimingEntry& entry = entries[name];
+    entry.histogram.add(ms);
+    entry.lastMs = ms;
+    entry.sumMs += ms;
+    entry.minMs = std::min(entry.minMs, ms);
+    entry.maxMs = std::max(entry.maxMs, ms);
+}
+
+bool Profiler::getStats(const std::string& name, TimingStats& stats) {
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    auto found = entries.find(name);
+    if (found == entries.end()) {
+        return false;
+    }
+    stats = makeStats(found->first, found->second);
+    return true;
+}
+
+std::vector<TimingStats> Profiler::allStats() {
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    std::vector<TimingStats> result;
+    for (const auto& item : entries) {
+        result.push_back(makeStats(item.first, item.second));
+    }
+    return result;
+}
+
+bool Profiler::dumpToFile(const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+        LOG_ERROR("Failed to open timing file " << path);
+        return false;
+    }
+
+    file << "name,count,last_ms,mean_ms,min_ms,p50_ms,p95_ms,max_ms,histogram\n";
+
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    for (const auto& item : entries) {
+        TimingStats stats = makeStats(item.first, item.second);
+        file << "\"" << stats.name << "\"," << stats.count << "," << stats.lastMs << "," << stats.meanMs << ","
+             << stats.minMs << "," << stats.p50Ms << "," << stats.p95Ms << "," << stats.maxMs << ",";
+
+        const std::vector<size_t>& buckets = item.second.histogram.bucketCounts();
+        bool first = true;
+        for (int bucket = 0; bucket < (int)buckets.size(); bucket++) {
+            if (buckets[bucket] > 0) {
+                file << (first ? "" : ";") << LatencyHistogram::bucketUpperMs(bucket) << ":" << buckets[bucket];
+                first = false;
+            }
+        }
+        file << "\n";
+    }
+
+    LOG_INFO("Wrote " << entries.size() << " timing entries to " << path);
+    return true;
+}
+
+void Profiler::reset() {
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    entries.clear();
+}
+
+ScopedTimer::ScopedTimer(const std::string& name) : name(name), start(std::chrono::steady_clock::now()) {
+}
+
+ScopedTimer::~ScopedTimer() {
+    double ms = elapsedMs();
+    Profiler::record(name, ms);
+    LOG_TRACE(name << " took " << ms << " ms");
+}
+
+double ScopedTimer::elapsedMs() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
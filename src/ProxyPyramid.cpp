@@ -0,0 +1,223 @@
+#include "ProxyPyramid.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+
+namespace {
+
+// 缩放奇数核大小，结果不小于minimum
+double scaleKernel(double kernelSize, double scale, int minimum) {
+    int scaled = (int)std::lround(kernelSize * scale) | 1;
+    return std::max(minimum, scaled);
+}
+
+double scaleArea(double area, double scale) {
+    return std::max(1.0, std::round(area * scale * scale));
+}
+
+// 将缺省参数补为applyFunction的默认值
+void fillDefaults(std::vector<double>& params, std::initializer_list<double> defaults) {
+    size_t index = 0;
+    for (double value : defaults) {
+        if (params.size() <= index) {
+            params.push_back(value);
+        }
+        index++;
+    }
+}
+
+}
+
+ProxyPyramid::ProxyPyramid() {
+}
+
+double ProxyPyramid::levelScale(const cv::Size& imageSize, const cv::Size& displaySize) {
+    if (imageSize.width <= 0 || imageSize.height <= 0 || displaySize.width <= 0 || displaySize.height <= 0) {
+        return 1.0;
+    }
+
+    double fitScale = std::min((double)displaySize.width / imageSize.width, (double)displaySize.height / imageSize.height);
+    if (fitScale >= 1.0) {
+        return 1.0;
+    }
+    // 选择不小于显示尺寸的最小一层
+    int level = (int)std::floor(std::log2(1.0 / fitScale));
+    return std::ldexp(1.0, -level);
+}
+
+cv::Mat ProxyPyramid::proxyFor(const cv::Mat& image, const cv::Size& displaySize, double* scale) {
+    *scale = levelScale(image.size(), displaySize);
+    if (image.empty() || *scale >= 1.0) {
+        *scale = 1.0;
+        return image;
+    }
+    int level = (int)std::lround(-std::log2(*scale));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (source.data != image.data || source.size() != image.size() || source.type() != image.type() ||
+        source.step[0] != image.step[0]) {
+        source = image;
+        levels.clear();
+    }
+
+    auto found = levels.find(level);
+    if (found != levels.end()) {
+        return found->second;
+    }
+
+    // 从已缓存的最近一层继续缩小，避免每层都读取全分辨率图像
+    cv::Mat base = source;
+    auto larger = levels.lower_bound(level);
+    if (larger != levels.begin()) {
+        base = std::prev(larger)->second;
+    }
+
+    cv::Size levelSize(std::max(1, (int)std::lround(source.cols * *scale)),
+                       std::max(1, (int)std::lround(source.rows * *scale)));
+    cv::Mat proxy;
+    cv::resize(base, proxy, levelSize, 0, 0, cv::INTER_AREA);
+    levels[level] = proxy;
+
+    LOG_DEBUG("Built preview proxy level " << level << ": " << source.cols << "x" << source.rows
+              << " -> " << proxy.cols << "x" << proxy.rows);
+    return proxy;
+}
+
+void ProxyPyramid::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    source.release();
+    levels.clear();
+}
+
+PipelineStep ProxyPyramid::scaleStep(const PipelineStep& step, double scale) {
+    if (scale == 1.0) {
+        return step;
+    }
+
+    PipelineStep scaled = step;
+    std::vector<double>& p = scaled.params;
+
+    switch (step.module) {
+        case PipelineModule::PRE_PROCESSING:
+            switch ((PreProcessingFunction)step.function) {
+                case PreProcessingFunction::FLATTEN_BACKGROUND:
+                    fillDefaults(p, {15});
+                    p[0] = scaleKernel(p[0], scale, 3);
+                    break;
+                case PreProcessingFunction::MEDIAN_FILTER:
+                case PreProcessingFunction::WIENER_FILTER:
+                case PreProcessingFunction::AVERAGE_BLUR:
+                case PreProcessingFunction::GRAYSCALE_DILATE:
+                case PreProcessingFunction::GRAYSCALE_ERODE:
+                case PreProcessingFunction::STDDEV_FILTER:
+                case PreProcessingFunction::ENTROPY_FILTER:
+                case PreProcessingFunction::BRIGHT_TEXTURE:
+                case PreProcessingFunction::DARK_TEXTURE:
+                    fillDefaults(p, {5});
+                    p[0] = scaleKernel(p[0], scale, 3);
+                    break;
+                case PreProcessingFunction::SUM_FILTER: {
+                    // 窗口面积随核缩小，按面积之比放大scale，使预览的和与全分辨率相当
+                    fillDefaults(p, {5, -1, 1.0});
+                    double kernelSize = p[0];
+                    p[0] = scaleKernel(p[0], scale, 3);
+                    p[2] *= (kernelSize * kernelSize) / (p[0] * p[0]);
+                    break;
+                }
+                case PreProcessingFunction::ADVANCED_TEXTURE:
+                case PreProcessingFunction::SIMILARITY:
+                    fillDefaults(p, {5});
+                    p[0] = scaleKernel(p[0], scale, 1);
+                    break;
+                case PreProcessingFunction::NON_LOCAL_MEANS:
+                    fillDefaults(p, {10.0, 7, 21});
+                    p[1] = scaleKernel(p[1], scale, 3);
+                    p[2] = std::max(p[1], scaleKernel(p[2], scale, 3));
+                    break;
+                case PreProcessingFunction::GAUSSIAN_BLUR:
+                    fillDefaults(p, {5, 1.0, 1.0});
+                    // 核大小不大于0表示由σ推算，保持不变
+                    if (p[0] > 0) {
+                        p[0] = scaleKernel(p[0], scale, 1);
+                    }
+                    p[1] *= scale;
+                    p[2] *= scale;
+                    break;
+                case PreProcessingFunction::FFT_FILTER:
+                    // 全分辨率下的频率f在缩小的图像上对应f/scale（同样以奈奎斯特频率为单位）
+                    fillDefaults(p, {0, 0.16, 0.5, 0.5, 0.0});
+                    for (size_t i = 1; i < 5; i++) {
+                        p[i] /= scale;
+                    }
+                    break;
+                default:
+                    // 逐像素操作或固定3x3核，无需换算
+                    break;
+            }
+            break;
+        case PipelineModule::SEGMENTATION:
+            switch ((SegmentationFunction)step.function) {
+                case SegmentationFunction::ADAPTIVE_THRESHOLD:
+                    fillDefaults(p, {0, 0, 11, 2.0});
+                    p[2] = scaleKernel(p[2], scale, 3);
+                    break;
+                case SegmentationFunction::LOCAL_THRESHOLD:
+                    fillDefaults(p, {11, 2.0});
+                    p[0] = scaleKernel(p[0], scale, 3);
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case PipelineModule::MORPHOLOGY:
+            fillDefaults(p, {5});
+            p[0] = scaleKernel(p[0], scale, 1);
+            break;
+        case PipelineModule::CLEAN_UP:
+            switch ((CleanUpFunction)step.function) {
+                case CleanUpFunction::FILL_ALL_HOLES:
+                    fillDefaults(p, {50});
+                    p[0] = scaleArea(p[0], scale);
+                    break;
+                case CleanUpFunction::REJECT_FEATURES:
+                    fillDefaults(p, {10, 1000});
+                    p[0] = scaleArea(p[0], scale);
+                    p[1] = scaleArea(p[1], scale);
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case PipelineModule::MEASUREMENTS:
+            fillDefaults(p, {10, 10000});
+            p[0] = scaleArea(p[0], scale);
+            p[1] = scaleArea(p[1], scale);
+            break;
+        default:
+            break;
+    }
+    return scaled;
+}
+
+MeasurementResult ProxyPyramid::unscaleMeasurement(const MeasurementResult& result, double scale) {
+    if (scale >= 1.0 || result.objectCount == 0) {
+        return result;
+    }
+
+    MeasurementResult unscaled = result;
+    double areaFactor = 1.0 / (scale * scale);
+    unscaled.totalArea = result.totalArea * areaFactor;
+    unscaled.averageSize = result.averageSize * areaFactor;
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1);
+    ss << "Objects: " << unscaled.objectCount << "\n";
+    ss << "Total Area: " << unscaled.totalArea << " px²\n";
+    ss << "Average Size: " << unscaled.averageSize << " px²\n";
+    ss << "Preview at " << std::setprecision(0) << scale * 100 << "% scale, areas are estimates";
+    unscaled.details = ss.str();
+    return unscaled;
+}
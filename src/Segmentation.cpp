@@ -1,4 +1,6 @@
 #include "Segmentation.h"
+#include "Logger.h"
+#include "Profiler.h"
 #include <iostream>
 
 Segmentation::Segmentation() {
@@ -11,7 +13,7 @@ Segmentation::~Segmentation() {
 cv::Mat Segmentation::basicThreshold(const cv::Mat& image, double threshold, int type) {
     cv::Mat result;
 
-    std::cout << "DEBUG: basicThreshold input - size=" << image.size() << ", channels=" << image.channels() << std::endl;
+    LOG_DEBUG("basicThreshold input - size=" << image.size() << ", channels=" << image.channels());
 
     // Apply threshold directly based on input image type
     if (image.channels() == 1) {
@@ -28,8 +30,8 @@ cv::Mat Segmentation::basicThreshold(const cv::Mat& image, double threshold, int
         result = image.clone();
     }
 
-    std::cout << "DEBUG: basicThreshold applied with threshold=" << threshold << ", type=" << type
-              << ", result channels=" << result.channels() << std::endl;
+    LOG_DEBUG("basicThreshold applied with threshold=" << threshold << ", type=" << type
+              << ", result channels=" << result.channels());
     return result;
 }
 
@@ -47,8 +49,8 @@ cv::Mat Segmentation::rangeThreshold(const cv::Mat& image, double minVal, double
     // Apply range threshold using inRange
     cv::inRange(grayImage, cv::Scalar(minVal), cv::Scalar(maxVal), result);
 
-    std::cout << "DEBUG: rangeThreshold applied with minVal=" << minVal << ", maxVal=" << maxVal
-              << ", result channels=" << result.channels() << std::endl;
+    LOG_DEBUG("rangeThreshold applied with minVal=" << minVal << ", maxVal=" << maxVal
+              << ", result channels=" << result.channels());
     return result;
 }
 
@@ -73,8 +75,8 @@ cv::Mat Segmentation::adaptiveThreshold(const cv::Mat& image, int method, int ty
     
     cv::adaptiveThreshold(grayImage, result, 255, adaptiveMethod, thresholdType, blockSize, C);
 
-    std::cout << "DEBUG: adaptiveThreshold applied with method=" << method << ", type=" << type
-              << ", blockSize=" << blockSize << ", C=" << C << ", result channels=" << result.channels() << std::endl;
+    LOG_DEBUG("adaptiveThreshold applied with method=" << method << ", type=" << type
+              << ", blockSize=" << blockSize << ", C=" << C << ", result channels=" << result.channels());
     return result;
 }
 
@@ -92,7 +94,7 @@ cv::Mat Segmentation::emThreshold(const cv::Mat& image) {
     // Use Otsu's method (EM-like threshold)
     cv::threshold(grayImage, result, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
     
-    std::cout << "DEBUG: emThreshold (OTSU) applied, result channels=" << result.channels() << std::endl;
+    LOG_DEBUG("emThreshold (OTSU) applied, result channels=" << result.channels());
     return result;
 }
 
@@ -103,6 +105,7 @@ cv::Mat Segmentation::localThreshold(const cv::Mat& image, int blockSize, double
 
 // 统一的应用函数
 cv::Mat Segmentation::applyFunction(const cv::Mat& image, SegmentationFunction function, const std::vector<double>& params) {
+    ScopedTimer timer("Segmentation #" + std::to_string((int)function));
     switch (function) {
         case SegmentationFunction::BASIC_THRESHOLD:
             return basicThreshold(image, params.size() > 0 ? params[0] : 127.0, params.size() > 1 ? (int)params[1] : 0);
@@ -0,0 +1,324 @@
+#include "TiffImageSource.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cctype>
+
+#ifdef HAVE_TIFF
+#include <tiffio.h>
+#endif
+
+TiffImageSource::TiffImageSource(const std::string& path, size_t cacheBudget)
+    : path(path), handle(nullptr), fileType(-1), cacheBytes(0), cacheBudgetBytes(cacheBudget) {
+    if (!readHeader()) {
+        levels.clear();
+    }
+}
+
+TiffImageSource::~TiffImageSource() {
+    // 读取文件头的句柄也在句柄池中
+    for (void* tif : idleHandles) {
+        closeHandle(tif);
+    }
+}
+
+bool TiffImageSource::isOpen() const {
+    return handle != nullptr && !levels.empty();
+}
+
+cv::Size TiffImageSource::size() const {
+    return levelSize(0);
+}
+
+int TiffImageSource::levelCount() const {
+    return (int)levels.size();
+}
+
+cv::Size TiffImageSource::levelSize(int level) const {
+    if (level < 0 || level >= (int)levels.size()) {
+        return cv::Size();
+    }
+    return levels[level].size;
+}
+
+int TiffImageSource::levelForPixels(size_t maxPixels) const {
+    for (int i = 0; i < (int)levels.size(); i++) {
+        if ((size_t)levels[i].size.area() <= maxPixels) {
+            return i;
+        }
+    }
+    return levels.empty() ? 0 : (int)levels.size() - 1;
+}
+
+cv::Mat TiffImageSource::readRegion(const cv::Rect& region) {
+    return readRegion(region, 0);
+}
+
+cv::Mat TiffImageSource::readRegion(const cv::Rect& region, int level) {
+    if (!isOpen() || level < 0 || level >= (int)levels.size()) {
+        return cv::Mat();
+    }
+
+    const Level& info = levels[level];
+    cv::Rect area = region & cv::Rect(0, 0, info.size.width, info.size.height);
+    if (area.empty()) {
+        return cv::Mat();
+    }
+
+    cv::Mat result(area.size(), CV_8UC3);
+    int blocksAcross = (info.size.width + info.blockWidth - 1) / info.blockWidth;
+    int firstX = area.x / info.blockWidth;
+    int lastX = (area.x + area.width - 1) / info.blockWidth;
+    int firstY = area.y / info.blockHeight;
+    int lastY = (area.y + area.height - 1) / info.blockHeight;
+
+    for (int by = firstY; by <= lastY; by++) {
+        for (int bx = firstX; bx <= lastX; bx++) {
+            int index = info.tiled ? by * blocksAcross + bx : by;
+            cv::Mat block = fetchBlock(level, index);
+            if (block.empty()) {
+                return cv::Mat();
+            }
+
+            cv::Rect blockRect(bx * info.blockWidth, by * info.blockHeight, block.cols, block.rows);
+            cv::Rect overlap = blockRect & area;
+            block(overlap - blockRect.tl()).copyTo(result(overlap - area.tl()));
+        }
+    }
+    return result;
+}
+
+cv::Mat TiffImageSource::fetchBlock(int level, int index) {
+    BlockKey key{level, index};
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        auto found = blockCache.find(key);
+        if (found != blockCache.end()) {
+            lruOrder.splice(lruOrder.begin(), lruOrder, found->second.second);
+            return found->second.first;
+        }
+        if (decoding.count(key) == 0) {
+            break;
+        }
+        blockDecoded.wait(lock);
+    }
+
+    decoding.insert(key);
+    void* tif = nullptr;
+    if (!idleHandles.empty()) {
+        tif = idleHandles.back();
+        idleHandles.pop_back();
+    }
+    lock.unlock();
+
+    if (!tif) {
+        tif = openHandle();
+    }
+    cv::Mat block = tif ? decodeBlock(tif, level, index) : cv::Mat();
+
+    lock.lock();
+    if (tif) {
+        idleHandles.push_back(tif);
+    }
+    decoding.erase(key);
+    if (!block.empty()) {
+        lruOrder.push_front(key);
+        blockCache[key] = std::make_pair(block, lruOrder.begin());
+        cacheBytes += block.total() * block.elemSize();
+        evictBlocks();
+    }
+    lock.unlock();
+    blockDecoded.notify_all();
+    return block;
+}
+
+std::shared_ptr<TileSource> TiffImageSource::openFile(const std::string& path) {
+    std::string extension = path.substr(path.find_last_of('.') + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+    if (extension == "tif" || extension == "tiff") {
+        std::shared_ptr<TiffImageSource> tiff = std::make_shared<TiffImageSource>(path);
+        if (tiff->isOpen()) {
+            return tiff;
+        }
+        LOG_DEBUG("TIFF region decoding unavailable for " << path << ", falling back to imread");
+    }
+
+    cv::Mat image = cv::imread(path);
+    if (image.empty()) {
+        return nullptr;
+    }
+    return std::make_shared<MatTileSource>(image);
+}
+
+#ifdef HAVE_TIFF
+
+bool TiffImageSource::readHeader() {
+    TIFF* tif = TIFFOpen(path.c_str(), "r");
+    if (!tif) {
+        return false;
+    }
+    handle = tif;
+    idleHandles.push_back(tif);
+
+    uint16_t bitsPerSample = 0, samplesPerPixel = 1, planar = PLANARCONFIG_CONTIG;
+    uint16_t photometric = 0, sampleFormat = SAMPLEFORMAT_UINT, compression = COMPRESSION_NONE;
+    int baseSamples = -1, baseBits = -1;
+
+    for (int directory = 0; ; directory++) {
+        if (directory > 0 && !TIFFReadDirectory(tif)) {
+            break;
+        }
+
+        uint32_t width = 0, height = 0;
+        TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
+        TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_BITSPERSAMPLE, &bitsPerSample);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &samplesPerPixel);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_PLANARCONFIG, &planar);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLEFORMAT, &sampleFormat);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_COMPRESSION, &compression);
+        photometric = samplesPerPixel == 1 ? PHOTOMETRIC_MINISBLACK : PHOTOMETRIC_RGB;
+        TIFFGetField(tif, TIFFTAG_PHOTOMETRIC, &photometric);
+
+        bool supported = (bitsPerSample == 8 || bitsPerSample == 16) && sampleFormat == SAMPLEFORMAT_UINT &&
+                         planar == PLANARCONFIG_CONTIG &&
+                         ((samplesPerPixel == 1 && photometric == PHOTOMETRIC_MINISBLACK) ||
+                          ((samplesPerPixel == 3 || samplesPerPixel == 4) && photometric == PHOTOMETRIC_RGB) ||
+                          (samplesPerPixel == 3 && photometric == PHOTOMETRIC_YCBCR && compression == COMPRESSION_JPEG));
+
+        if (directory == 0) {
+            if (!supported) {
+                return false;
+            }
+            baseSamples = samplesPerPixel;
+            baseBits = bitsPerSample;
+        } else if (!supported || samplesPerPixel != baseSamples || bitsPerSample != baseBits ||
+                   (int)width >= levels.back().size.width) {
+            continue;   // 缩略图、标签图等非金字塔目录
+        }
+
+        Level level;
+        level.directory = directory;
+        level.size = cv::Size((int)width, (int)height);
+        level.tiled = TIFFIsTiled(tif) != 0;
+        level.jpegYCbCr = photometric == PHOTOMETRIC_YCBCR;
+        if (level.tiled) {
+            uint32_t tileWidth = 0, tileHeight = 0;
+            TIFFGetField(tif, TIFFTAG_TILEWIDTH, &tileWidth);
+            TIFFGetField(tif, TIFFTAG_TILELENGTH, &tileHeight);
+            level.blockWidth = (int)tileWidth;
+            level.blockHeight = (int)tileHeight;
+        } else {
+            uint32_t rowsPerStrip = height;
+            TIFFGetFieldDefaulted(tif, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip);
+            level.blockWidth = (int)width;
+            level.blockHeight = (int)std::min(rowsPerStrip, height);
+        }
+        if (level.blockWidth <= 0 || level.blockHeight <= 0) {
+            if (directory == 0) {
+                return false;
+            }
+            continue;
+        }
+        levels.push_back(level);
+    }
+
+    // 回到原始分辨率的目录，decodeBlock只在层级切换时重新设置目录
+    TIFFSetDirectory(tif, 0);
+    if (levels[0].jpegYCbCr) {
+        TIFFSetField(tif, TIFFTAG_JPEGCOLORMODE, JPEGCOLORMODE_RGB);
+    }
+
+    fileType = CV_MAKETYPE(baseBits == 8 ? CV_8U : CV_16U, baseSamples);
+
+    const Level& base = levels[0];
+    LOG_INFO("Opened TIFF " << path << ": " << base.size.width << "x" << base.size.height << ", "
+             << (base.tiled ? "tiled " : "striped ") << base.blockWidth << "x" << base.blockHeight
+             << ", " << levels.size() << " pyramid levels");
+    return true;
+}
+
+void* TiffImageSource::openHandle() {
+    // 并行解码时按需为新的线程打开句柄，之后留在句柄池中复用
+    TIFF* tif = TIFFOpen(path.c_str(), "r");
+    if (!tif) {
+        LOG_ERROR("Failed to reopen TIFF " << path);
+        return nullptr;
+    }
+    if (levels[0].jpegYCbCr) {
+        TIFFSetField(tif, TIFFTAG_JPEGCOLORMODE, JPEGCOLORMODE_RGB);
+    }
+    return tif;
+}
+
+void TiffImageSource::closeHandle(void* tif) {
+    TIFFClose((TIFF*)tif);
+}
+
+cv::Mat TiffImageSource::decodeBlock(void* tiffHandle, int level, int index) {
+    TIFF* tif = (TIFF*)tiffHandle;
+    const Level& info = levels[level];
+    if ((int)TIFFCurrentDirectory(tif) != info.directory) {
+        if (!TIFFSetDirectory(tif, (tdir_t)info.directory)) {
+            LOG_ERROR("Failed to select TIFF directory " << info.directory << " in " << path);
+            return cv::Mat();
+        }
+        if (info.jpegYCbCr) {
+            TIFFSetField(tif, TIFFTAG_JPEGCOLORMODE, JPEGCOLORMODE_RGB);
+        }
+    }
+
+    cv::Mat block;
+    tmsize_t decoded;
+    if (info.tiled) {
+        block.create(info.blockHeight, info.blockWidth, fileType);
+        decoded = TIFFReadEncodedTile(tif, (uint32_t)index, block.data, (tmsize_t)(block.total() * block.elemSize()));
+    } else {
+        int rows = std::min(info.blockHeight, info.size.height - index * info.blockHeight);
+        block.create(rows, info.blockWidth, fileType);
+        decoded = TIFFReadEncodedStrip(tif, (uint32_t)index, block.data, (tmsize_t)(block.total() * block.elemSize()));
+    }
+    if (decoded < 0) {
+        LOG_ERROR("Failed to decode TIFF block " << index << " at level " << level << " in " << path);
+        return cv::Mat();
+    }
+
+    // 转换为与cv::imread默认方式相同的8位BGR
+    if (block.depth() == CV_16U) {
+        block.convertTo(block, CV_8U, 1.0 / 256);
+    }
+    int conversion = block.channels() == 1 ? cv::COLOR_GRAY2BGR
+                   : block.channels() == 4 ? cv::COLOR_RGBA2BGR : cv::COLOR_RGB2BGR;
+    cv::cvtColor(block, block, conversion);
+    return block;
+}
+
+#else
+
+bool TiffImageSource::readHeader() {
+    return false;
+}
+
+void* TiffImageSource::openHandle() {
+    return nullptr;
+}
+
+void TiffImageSource::closeHandle(void*) {
+}
+
+cv::Mat TiffImageSource::decodeBlock(void*, int, int) {
+    return cv::Mat();
+}
+
+#endif
+
+void TiffImageSource::evictBlocks() {
+    // 至少保留最近使用的分块
+    while (cacheBytes > cacheBudgetBytes && lruOrder.size() > 1) {
+        BlockKey oldest = lruOrder.back();
+        lruOrder.pop_back();
+        auto found = blockCache.find(oldest);
+        cacheBytes -= found->second.first.total() * found->second.first.elemSize();
+        blockCache.erase(found);
+    }
+}
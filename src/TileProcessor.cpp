@@ -0,0 +1,405 @@
+#include "TileProcessor.h"
+#include "Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+#ifdef HAVE_TIFF
+#include <tiffio.h>
+#endif
+
+// 来源与接收端
+
+MatTileSource::MatTileSource(const cv::Mat& image) : image(image) {
+}
+
+cv::Size MatTileSource::size() const {
+    return image.size();
+}
+
+cv::Mat MatTileSource::readRegion(const cv::Rect& region) {
+    // ROI与源图像共享缓冲区；步骤不会就地修改输入
+    return image(region);
+}
+
+MatTileSink::MatTileSink(const cv::Size& imageSize) : imageSize(imageSize) {
+}
+
+void MatTileSink::writeTile(const cv::Rect& region, const cv::Mat& tile) {
+    {
+        std::lock_guard<std::mutex> lock(allocationMutex);
+        if (result.empty()) {
+            result.create(imageSize, tile.type());
+        }
+    }
+    tile.copyTo(result(region));
+}
+
+const cv::Mat& MatTileSink::getResult() const {
+    return result;
+}
+
+TiffTileSink::TiffTileSink(const std::string& path, const cv::Size& imageSize, int tileSize)
+    : path(path), imageSize(imageSize), tileSize(tileSize), handle(nullptr), type(-1), failed(tileSize % 16 != 0) {
+    if (failed) {
+        LOG_ERROR("TiffTileSink: tile size " << tileSize << " is not a multiple of 16");
+    }
+}
+
+#ifdef HAVE_TIFF
+
+TiffTileSink::~TiffTileSink() {
+    if (handle) {
+        TIFFClose((TIFF*)handle);
+    }
+}
+
+namespace {
+
+bool tiffSampleFormat(int depth, uint16_t& bits, uint16_t& format) {
+    switch (depth) {
+        case CV_8U:  bits = 8;  format = SAMPLEFORMAT_UINT; return true;
+        case CV_8S:  bits = 8;  format = SAMPLEFORMAT_INT; return true;
+        case CV_16U: bits = 16; format = SAMPLEFORMAT_UINT; return true;
+        case CV_16S: bits = 16; format = SAMPLEFORMAT_INT; return true;
+        case CV_32S: bits = 32; format = SAMPLEFORMAT_INT; return true;
+        case CV_32F: bits = 32; format = SAMPLEFORMAT_IEEEFP; return true;
+        case CV_64F: bits = 64; format = SAMPLEFORMAT_IEEEFP; return true;
+        default: return false;
+    }
+}
+
+} // namespace
+
+void TiffTileSink::writeTile(const cv::Rect& region, const cv::Mat& tile) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (failed) {
+        return;
+    }
+
+    if (!handle) {
+        uint16_t bits = 0, format = 0;
+        int channels = tile.channels();
+        if (!tiffSampleFormat(tile.depth(), bits, format) || channels == 2 || channels > 4) {
+            LOG_ERROR("TiffTileSink: unsupported tile type " << tile.type() << " for " << path);
+            failed = true;
+            return;
+        }
+
+        // 经典TIFF的偏移量是32位，留出目录和压缩膨胀的余量
+        double bytes = (double)imageSize.area() * tile.elemSize();
+        TIFF* tif = TIFFOpen(path.c_str(), bytes > 3.5e9 ? "w8" : "w");
+        if (!tif) {
+            LOG_ERROR("TiffTileSink: failed to create " << path);
+            failed = true;
+            return;
+        }
+        TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, (uint32_t)imageSize.width);
+        TIFFSetField(tif, TIFFTAG_IMAGELENGTH, (uint32_t)imageSize.height);
+        TIFFSetField(tif, TIFFTAG_TILEWIDTH, (uint32_t)tileSize);
+        TIFFSetField(tif, TIFFTAG_TILELENGTH, (uint32_t)tileSize);
+        TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, bits);
+        TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, format);
+        TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, (uint16_t)channels);
+        TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+        TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, channels == 1 ? PHOTOMETRIC_MINISBLACK : PHOTOMETRIC_RGB);
+        if (channels == 4) {
+            uint16_t extra = EXTRASAMPLE_UNASSALPHA;
+            TIFFSetField(tif, TIFFTAG_EXTRASAMPLES, 1, &extra);
+        }
+        TIFFSetField(tif, TIFFTAG_COMPRESSION, COMPRESSION_LZW);
+        handle = tif;
+        type = tile.type();
+    }
+
+    if (tile.type() != type || region.x % tileSize != 0 || region.y % tileSize != 0 ||
+        region.width > tileSize || region.height > tileSize) {
+        LOG_ERROR("TiffTileSink: tile " << region << " of type " << tile.type() << " does not match the layout of " << path);
+        failed = true;
+        return;
+    }
+
+    // 右侧和底部不完整的分块补零到完整的TIFF分块
+    cv::Mat block = cv::Mat::zeros(tileSize, tileSize, type);
+    cv::Mat core = block(cv::Rect(0, 0, region.width, region.height));
+    if (tile.channels() == 3) {
+        cv::cvtColor(tile, core, cv::COLOR_BGR2RGB);
+    } else if (tile.channels() == 4) {
+        cv::cvtColor(tile, core, cv::COLOR_BGRA2RGBA);
+    } else {
+        tile.copyTo(core);
+    }
+    if (TIFFWriteTile((TIFF*)handle, block.data, (uint32_t)region.x, (uint32_t)region.y, 0, 0) < 0) {
+        LOG_ERROR("TiffTileSink: failed to write tile " << region << " to " << path);
+        failed = true;
+    }
+}
+
+bool TiffTileSink::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!handle) {
+        return false;
+    }
+    TIFFClose((TIFF*)handle);
+    handle = nullptr;
+    return !failed;
+}
+
+bool TiffTileSink::isAvailable() {
+    return true;
+}
+
+#else
+
+TiffTileSink::~TiffTileSink() {
+}
+
+void TiffTileSink::writeTile(const cv::Rect&, const cv::Mat&) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!failed) {
+        LOG_ERROR("TiffTileSink: built without libtiff, cannot write " << path);
+        failed = true;
+    }
+}
+
+bool TiffTileSink::close() {
+    return false;
+}
+
+bool TiffTileSink::isAvailable() {
+    return false;
+}
+
+#endif
+
+// 重叠边
+
+int TileProcessor::oddKernelRadius(double kernelSize) {
+    return std::max(0, (int)kernelSize / 2);
+}
+
+int TileProcessor::haloFor(const PipelineStep& step) {
+    const std::vector<double>& p = step.params;
+    auto param = [&p](size_t index, double defaultValue) {
+        return p.size() > index ? p[index] : defaultValue;
+    };
+
+    switch (step.module) {
+        case PipelineModule::PRE_PROCESSING:
+            switch ((PreProcessingFunction)step.function) {
+                case PreProcessingFunction::ADJUST_CONTRAST:
+                    return 0;
+                case PreProcessingFunction::FLATTEN_BACKGROUND:
+                    return 2 * oddKernelRadius(param(0, 15));   // 顶帽 = 腐蚀 + 膨胀
+                case PreProcessingFunction::WIENER_FILTER:
+                    // 估计的噪声方差是全图局部方差的平均值，只有给定噪声时才能分块
+                    return param(1, 0.0) > 0 ? oddKernelRadius(param(0, 5)) : -1;
+                case PreProcessingFunction::MEDIAN_FILTER:
+                case PreProcessingFunction::AVERAGE_BLUR:
+                case PreProcessingFunction::SUM_FILTER:
+                case PreProcessingFunction::GRAYSCALE_DILATE:
+                case PreProcessingFunction::GRAYSCALE_ERODE:
+                case PreProcessingFunction::STDDEV_FILTER:
+                case PreProcessingFunction::ENTROPY_FILTER:
+                case PreProcessingFunction::BRIGHT_TEXTURE:
+                case PreProcessingFunction::DARK_TEXTURE:
+                case PreProcessingFunction::SIMILARITY:
+                    return oddKernelRadius(param(0, 5));
+                case PreProcessingFunction::NON_LOCAL_MEANS:
+                    return oddKernelRadius(param(1, 7)) + oddKernelRadius(param(2, 21));
+                case PreProcessingFunction::GAUSSIAN_BLUR: {
+                    int kernelSize = (int)param(0, 5);
+                    double sx, sy;
+                    if (PreProcessing::usesRecursiveGaussian(kernelSize, param(1, 1.0), param(2, 1.0), sx, sy)) {
+                        // 递归高斯的支撑不截断，在±4σ外的贡献可以忽略
+                        return (int)std::ceil(4 * std::max(sx, sy));
+                    }
+                    if (kernelSize > 0) {
+                        return oddKernelRadius(kernelSize);
+                    }
+                    // 核大小由sigma决定时，OpenCV最多取 ±4σ
+                    double sigma = std::max(param(1, 1.0), param(2, 1.0));
+                    return (int)std::ceil(sigma * 4) + 1;
+                }
+                case PreProcessingFunction::GRADIENT_FILTER:
+                case PreProcessingFunction::SHARPEN:
+                    return 1;
+                case PreProcessingFunction::ADVANCED_TEXTURE:
+                    return std::max(1, oddKernelRadius(param(0, 5)));
+                case PreProcessingFunction::FFT_FILTER:
+                    return -1;      // 频域掩模作用于整幅图像的频谱
+                case PreProcessingFunction::GRAYSCALE_INTERPOLATION:
+                    return 2;       // 放大再缩小的双线性插值
+                case PreProcessingFunction::GRAYSCALE_RECONSTRUCTION:
+                    return 4;       // 5x5闭运算
+                default:
+                    return -1;      // 全局直方图、Canny滞后阈值等
+            }
+
+        case PipelineModule::SEGMENTATION:
+            switch ((SegmentationFunction)step.function) {
+                case SegmentationFunction::BASIC_THRESHOLD:
+                case SegmentationFunction::RANGE_THRESHOLD:
+                    return 0;
+                case SegmentationFunction::ADAPTIVE_THRESHOLD:
+                    return std::max(1, oddKernelRadius(param(2, 11)));
+                case SegmentationFunction::LOCAL_THRESHOLD:
+                    return std::max(1, oddKernelRadius(param(0, 11)));
+                default:
+                    return -1;      // Otsu阈值依赖全局直方图
+            }
+
+        case PipelineModule::MORPHOLOGY: {
+            int radius = oddKernelRadius(param(0, 5));
+            switch ((MorphologyFunction)step.function) {
+                case MorphologyFunction::DILATE:
+                case MorphologyFunction::ERODE:
+                case MorphologyFunction::GRADIENT:
+                    return radius;
+                case MorphologyFunction::OPENING:
+                case MorphologyFunction::CLOSING:
+                case MorphologyFunction::TOP_HAT:
+                case MorphologyFunction::BLACK_HAT:
+                    return 2 * radius;
+                default:
+                    return -1;      // 轮廓分离需要完整的连通域
+            }
+        }
+
+        case PipelineModule::COLOR:
+            switch ((ColorFunction)step.function) {
+                case ColorFunction::CONVERT_GRAYSCALE:
+                case ColorFunction::COLOR_SELECT:
+                case ColorFunction::COLOR_DECONVOLUTION:
+                case ColorFunction::CHANNEL_OPERATION:
+                    return 0;
+                default:
+                    return -1;      // K-means聚类依赖全部像素
+            }
+
+        default:
+            return -1;              // 清理与测量基于完整的连通域
+    }
+}
+
+bool TileProcessor::isTileable(const std::vector<PipelineStep>& steps) {
+    for (const PipelineStep& step : steps) {
+        if (haloFor(step) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int TileProcessor::totalHalo(const std::vector<PipelineStep>& steps) {
+    int total = 0;
+    for (const PipelineStep& step : steps) {
+        total += std::max(0, haloFor(step));
+    }
+    return total;
+}
+
+// 执行
+
+bool TileProcessor::run(TileSource& source, TileSink& sink, const std::vector<PipelineStep>& steps, const TileOptions& options) {
+    if (!isTileable(steps)) {
+        LOG_WARN("TileProcessor: pipeline contains steps that cannot be tiled");
+        return false;
+    }
+
+    cv::Size imageSize = source.size();
+    int tileSize = std::max(16, options.tileSize);
+    int halo = totalHalo(steps);
+    int tilesX = (imageSize.width + tileSize - 1) / tileSize;
+    int tilesY = (imageSize.height + tileSize - 1) / tileSize;
+    int tileCount = tilesX * tilesY;
+    if (tileCount == 0) {
+        return false;
+    }
+
+    int threadCount = options.threads > 0 ? std::min(options.threads, cv::getNumThreads()) : cv::getNumThreads();
+    threadCount = std::max(1, std::min(threadCount, tileCount));
+
+    LOG_INFO("TileProcessor: " << imageSize.width << "x" << imageSize.height << " in " << tileCount
+             << " tiles of " << tileSize << " px, halo " << halo << " px, " << threadCount << " threads");
+
+    std::atomic<int> nextTile(0);
+    std::atomic<bool> failed(false);
+    cv::Rect imageRect(0, 0, imageSize.width, imageSize.height);
+    auto startTime = std::chrono::steady_clock::now();
+
+    // 每个条带循环领取分块；分块内部的OpenCV调用处于并行区域内，自动串行执行，不会超额订阅
+    cv::parallel_for_(cv::Range(0, threadCount), [&](const cv::Range&) {
+        while (!failed) {
+            int index = nextTile.fetch_add(1);
+            if (index >= tileCount) {
+                break;
+            }
+
+            cv::Rect core((index % tilesX) * tileSize, (index / tilesX) * tileSize, tileSize, tileSize);
+            core &= imageRect;
+            cv::Rect padded(core.x - halo, core.y - halo, core.width + 2 * halo, core.height + 2 * halo);
+            padded &= imageRect;
+
+            try {
+                cv::Mat tile = source.readRegion(padded);
+                for (const PipelineStep& step : steps) {
+                    tile = Pipeline::applyStep(tile, step);
+                }
+                if (tile.size() != padded.size()) {
+                    LOG_ERROR("TileProcessor: step changed tile size from " << padded.size() << " to " << tile.size());
+                    failed = true;
+                    break;
+                }
+
+                cv::Rect inner(core.x - padded.x, core.y - padded.y, core.width, core.height);
+                sink.writeTile(core, tile(inner));
+            } catch (const std::exception& e) {
+                LOG_ERROR("TileProcessor: tile " << core << " failed: " << e.what());
+                failed = true;
+            }
+        }
+    }, threadCount);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    LOG_DEBUG("TileProcessor: finished " << tileCount << " tiles in " << seconds << " s");
+    return !failed;
+}
+
+cv::Mat TileProcessor::run(const cv::Mat& image, const std::vector<PipelineStep>& steps, const TileOptions& options,
+                           std::vector<MeasurementResult>* measurements) {
+    cv::Mat current = image;
+    size_t index = 0;
+
+    while (index < steps.size() && !current.empty()) {
+        // 收集连续的可分块步骤
+        std::vector<PipelineStep> tiled;
+        while (index < steps.size() && haloFor(steps[index]) >= 0) {
+            tiled.push_back(steps[index++]);
+        }
+
+        if (!tiled.empty()) {
+            MatTileSource source(current);
+            MatTileSink sink(current.size());
+            if (run(source, sink, tiled, options)) {
+                current = sink.getResult();
+            } else {
+                // 分块失败（例如步骤改变了图像尺寸）时退回整幅处理
+                for (const PipelineStep& step : tiled) {
+                    current = Pipeline::applyStep(current, step);
+                }
+            }
+        }
+
+        if (index < steps.size()) {
+            const PipelineStep& step = steps[index++];
+            MeasurementResult measurement;
+            current = Pipeline::applyStep(current, step, &measurement);
+            if (measurements && step.module == PipelineModule::MEASUREMENTS) {
+                measurements->push_back(measurement);
+            }
+        }
+    }
+    return current;
+}
@@ -1,7 +1,149 @@
 #include "UIComponents.h"
 #include <cvui.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
+ScaledImageCache::ScaledImageCache() : version(0), rangeMin(0.0), rangeMax(0.0) {
+}
+
+const cv::Mat& ScaledImageCache::get(const cv::Mat& image, uint64_t imageVersion, const cv::Size& targetSize,
+                                     const cv::Rect& targetRegion) {
+    bool sameImage = imageVersion == version && image.data == source.data && image.size() == source.size() &&
+                     image.type() == source.type();
+    if (!bitmap.empty() && sameImage && targetSize == maxSize && targetRegion == region) {
+        return bitmap;
+    }
+
+    // 窗口和等非8位结果按整幅图像的范围拉伸，平移或缩放时亮度不变；范围只在图像变化时重新统计
+    if (!sameImage && image.depth() != CV_8U) {
+        cv::minMaxLoc(image.reshape(1), &rangeMin, &rangeMax);
+    }
+
+    source = image;
+    version = imageVersion;
+    maxSize = targetSize;
+    region = targetRegion;
+
+    cv::Mat scaled;
+    cv::Rect visible = targetRegion & cv::Rect(cv::Point(), image.size());
+    if (visible.area() > 0) {
+        cv::Mat crop = image(visible);
+        double scale = std::min((double)targetSize.width / crop.cols, (double)targetSize.height / crop.rows);
+        cv::Size scaledSize(std::max(1, (int)std::lround(crop.cols * scale)), std::max(1, (int)std::lround(crop.rows * scale)));
+        cv::resize(crop, scaled, scaledSize, 0, 0, scale > 1.0 ? cv::INTER_NEAREST : cv::INTER_AREA);
+    } else {
+        scaled = UIComponents::scaleImageToFit(image, targetSize.width, targetSize.height);
+    }
+
+    if (scaled.depth() != CV_8U) {
+        double range = rangeMax - rangeMin;
+        double alpha = range > 0 ? 255.0 / range : 0.0;
+        cv::Mat stretched;
+        scaled.convertTo(stretched, CV_8U, alpha, -rangeMin * alpha);
+        scaled = stretched;
+    }
+
+    if (scaled.channels() == 1) {
+        cv::cvtColor(scaled, bitmap, cv::COLOR_GRAY2BGR);
+    } else {
+        bitmap = scaled;
+    }
+    return bitmap;
+}
+
+void ScaledImageCache::clear() {
+    source.release();
+    bitmap.release();
+    version = 0;
+    region = cv::Rect();
+}
+
+const double ImageViewport::kMaxPixelScale = 16.0;
+
+ImageViewport::ImageViewport() : zoom(1.0), dragging(false) {
+}
+
+void ImageViewport::reset() {
+    zoom = 1.0;
+    dragging = false;
+}
+
+bool ImageViewport::isZoomed() const {
+    return zoom > 1.0;
+}
+
+double ImageViewport::fitScale(const cv::Size& imageSize, const cv::Size& viewSize) {
+    if (imageSize.width <= 0 || imageSize.height <= 0) {
+        return 1.0;
+    }
+    // 与scaleImageToFit一致，未放大时小图像按原尺寸显示
+    return std::min(1.0, std::min((double)viewSize.width / imageSize.width, (double)viewSize.height / imageSize.height));
+}
+
+double ImageViewport::pixelScale(const cv::Size& imageSize, const cv::Size& viewSize) const {
+    return fitScale(imageSize, viewSize) * zoom;
+}
+
+cv::Rect ImageViewport::visibleRect(const cv::Size& imageSize, const cv::Size& viewSize) const {
+    cv::Rect whole(cv::Point(), imageSize);
+    if (!isZoomed() || whole.area() == 0) {
+        return whole;
+    }
+
+    double scale = pixelScale(imageSize, viewSize);
+    double visibleWidth = std::min((double)imageSize.width, viewSize.width / scale);
+    double visibleHeight = std::min((double)imageSize.height, viewSize.height / scale);
+
+    // 中心限制在图像内，使可见区域不越界
+    double centerX = std::min(std::max(center.x, visibleWidth / 2), imageSize.width - visibleWidth / 2);
+    double centerY = std::min(std::max(center.y, visibleHeight / 2), imageSize.height - visibleHeight / 2);
+
+    int x0 = (int)std::floor(centerX - visibleWidth / 2);
+    int y0 = (int)std::floor(centerY - visibleHeight / 2);
+    int x1 = (int)std::ceil(centerX + visibleWidth / 2);
+    int y1 = (int)std::ceil(centerY + visibleHeight / 2);
+    return cv::Rect(x0, y0, std::max(1, x1 - x0), std::max(1, y1 - y0)) & whole;
+}
+
+void ImageViewport::zoomBy(double factor, const cv::Size& imageSize, const cv::Size& viewSize) {
+    if (!isZoomed()) {
+        center = cv::Point2d(imageSize.width / 2.0, imageSize.height / 2.0);
+    }
+    double maxZoom = std::max(1.0, kMaxPixelScale / fitScale(imageSize, viewSize));
+    zoom = std::min(std::max(zoom * factor, 1.0), maxZoom);
+}
+
+void ImageViewport::zoomToPixelScale(double scale, const cv::Size& imageSize, const cv::Size& viewSize) {
+    zoomBy(scale / pixelScale(imageSize, viewSize), imageSize, viewSize);
+}
+
+bool ImageViewport::handleDrag(const cv::Rect& area, const cv::Point& mouse, bool pressed, bool down,
+                               const cv::Size& imageSize, const cv::Size& viewSize) {
+    if (!down) {
+        dragging = false;
+        return false;
+    }
+    if (pressed && area.contains(mouse)) {
+        dragging = true;
+        lastMouse = mouse;
+        return false;
+    }
+    if (!dragging || !isZoomed() || mouse == lastMouse) {
+        return false;
+    }
+
+    // 先把中心限制到可见区域允许的范围内，避免越界后拖动出现"死区"
+    cv::Rect visible = visibleRect(imageSize, viewSize);
+    center = cv::Point2d(visible.x + visible.width / 2.0, visible.y + visible.height / 2.0);
+
+    double scale = pixelScale(imageSize, viewSize);
+    center.x -= (mouse.x - lastMouse.x) / scale;
+    center.y -= (mouse.y - lastMouse.y) / scale;
+    lastMouse = mouse;
+    return true;
+}
+
 UIComponents::UIComponents() {
 }
 
@@ -18,7 +160,8 @@ cv::Mat UIComponents::scaleImageToFit(const cv::Mat& image, int maxWidth, int ma
     double scale = std::min(scaleX, scaleY);
 
     if (scale >= 1.0) {
-        return image.clone();
+        // 无需缩放时直接共享缓冲区，调用方只读
+        return image;
     }
 
     cv::Mat scaledImage;
@@ -26,24 +169,19 @@ cv::Mat UIComponents::scaleImageToFit(const cv::Mat& image, int maxWidth, int ma
     return scaledImage;
 }
 
-void UIComponents::renderPreviewArea(cv::Mat& frame, int x, int y, int width, int height, const cv::Mat& previewImage) {
+void UIComponents::renderPreviewArea(cv::Mat& frame, int x, int y, int width, int height, const cv::Mat& previewImage,
+                                     ScaledImageCache* cache, const cv::Rect& region) {
     // 绘制预览区域边框
     cv::rectangle(frame, cv::Rect(x, y, width, height), cv::Scalar(200, 200, 200), 1);
 
     if (!previewImage.empty()) {
-        cv::Mat scaledPreview = scaleImageToFit(previewImage, width - 10, height - 10);
-        if (!scaledPreview.empty()) {
-            int imgX = x + (width - scaledPreview.cols) / 2;
-            int imgY = y + (height - scaledPreview.rows) / 2;
-
-            // 确保图像是3通道的，以避免cvui::image的copyTo错误
-            cv::Mat displayPreview;
-            if (scaledPreview.channels() == 1) {
-                cv::cvtColor(scaledPreview, displayPreview, cv::COLOR_GRAY2BGR);
-            } else {
-                displayPreview = scaledPreview.clone();
-            }
-
+        // 确保图像是3通道的，以避免cvui::image的copyTo错误
+        ScaledImageCache localCache;
+        ScaledImageCache& displayCache = cache ? *cache : localCache;
+        const cv::Mat& displayPreview = displayCache.get(previewImage, 0, cv::Size(width - 10, height - 10), region);
+        if (!displayPreview.empty()) {
+            int imgX = x + (width - displayPreview.cols) / 2;
+            int imgY = y + (height - displayPreview.rows) / 2;
             cvui::image(frame, imgX, imgY, displayPreview);
         }
     } else {
@@ -51,6 +189,31 @@ void UIComponents::renderPreviewArea(cv::Mat& frame, int x, int y, int width, in
     }
 }
 
+bool UIComponents::renderZoomControls(cv::Mat& frame, int x, int y, int height, ImageViewport& viewport,
+                                      const cv::Size& imageSize, const cv::Size& viewSize) {
+    bool changed = false;
+    if (cvui::button(frame, x, y, 30, height, "-", 0.35)) {
+        viewport.zoomBy(0.5, imageSize, viewSize);
+        changed = true;
+    }
+    if (cvui::button(frame, x + 35, y, 30, height, "+", 0.35)) {
+        viewport.zoomBy(2.0, imageSize, viewSize);
+        changed = true;
+    }
+    if (cvui::button(frame, x + 70, y, 40, height, "Fit", 0.3)) {
+        viewport.reset();
+        changed = true;
+    }
+    if (cvui::button(frame, x + 115, y, 40, height, "1:1", 0.3)) {
+        viewport.zoomToPixelScale(1.0, imageSize, viewSize);
+        changed = true;
+    }
+
+    int percent = (int)std::lround(viewport.pixelScale(imageSize, viewSize) * 100);
+    cvui::text(frame, x + 165, y + height / 2 - 5, ("Zoom: " + std::to_string(percent) + "%").c_str(), 0.35);
+    return changed;
+}
+
 int UIComponents::renderModalButtons(cv::Mat& frame, int x, int y) {
     if (cvui::button(frame, x, y, 80, 30, "Apply", 0.35)) {
         return 1; // Apply clicked
@@ -65,7 +228,6 @@ int UIComponents::renderModalButtons(cv::Mat& frame, int x, int y) {
 
 bool UIComponents::renderAdjustContrastParameters(cv::Mat& frame, int startY, int controlAreaX, 
                                                 double& brightness, double& contrast,
-                                                double& prevBrightness, double& prevContrast,
                                                 PreProcessingFunction currentFunction) {
     int currentY = startY;
     
@@ -84,14 +246,8 @@ bool UIComponents::renderAdjustContrastParameters(cv::Mat& frame, int startY, in
     cvui::text(frame, controlAreaX, currentY, "Brightness: " + std::to_string((int)brightness), 0.3);
     cvui::text(frame, controlAreaX, currentY + 15, "Contrast: " + std::to_string(contrast).substr(0, 4), 0.3);
     
-    // 检测参数变化并自动更新预览
+    // 滑块的变化由ParameterTracker检测，这里只报告按钮
     bool needsUpdate = false;
-    if (brightness != prevBrightness || contrast != prevContrast) {
-        needsUpdate = true;
-        prevBrightness = brightness;
-        prevContrast = contrast;
-    }
-    
     if (cvui::button(frame, controlAreaX, currentY + 40, 120, 25, "Update Preview", 0.35)) {
         needsUpdate = true;
     }
@@ -101,7 +257,7 @@ bool UIComponents::renderAdjustContrastParameters(cv::Mat& frame, int startY, in
 
 bool UIComponents::renderHistogramEqualizationParameters(cv::Mat& frame, int startY, int controlAreaX,
                                                        int& histogramMethod, double& clipLimit,
-                                                       double& prevClipLimit, PreProcessingFunction currentFunction) {
+                                                       PreProcessingFunction currentFunction) {
     int currentY = startY;
     bool needsUpdate = false;
     
@@ -134,12 +290,6 @@ bool UIComponents::renderHistogramEqualizationParameters(cv::Mat& frame, int sta
         cvui::text(frame, controlAreaX + 210, currentY + 8, ("Value: " + std::to_string(clipLimit).substr(0, 4)).c_str(), 0.3);
         currentY += 40;
         
-        // 检测clipLimit变化并自动更新预览
-        if (clipLimit != prevClipLimit) {
-            needsUpdate = true;
-            prevClipLimit = clipLimit;
-        }
-        
         if (cvui::button(frame, controlAreaX, currentY, 120, 25, "Update Preview", 0.35)) {
             needsUpdate = true;
         }
@@ -149,7 +299,7 @@ bool UIComponents::renderHistogramEqualizationParameters(cv::Mat& frame, int sta
 }
 
 bool UIComponents::renderFlattenBackgroundParameters(cv::Mat& frame, int startY, int controlAreaX,
-                                                   int& flattenKernelSize, int& prevFlattenKernelSize,
+                                                   int& flattenKernelSize,
                                                    PreProcessingFunction currentFunction) {
     int currentY = startY;
     
@@ -172,17 +322,72 @@ bool UIComponents::renderFlattenBackgroundParameters(cv::Mat& frame, int startY,
     cvui::text(frame, controlAreaX, currentY, "Current kernel size: " + std::to_string(flattenKernelSize), 0.3);
     cvui::text(frame, controlAreaX, currentY + 15, "Larger values = more background removal", 0.25);
     
-    // 检测flattenKernelSize变化并自动更新预览
     bool needsUpdate = false;
-    if (flattenKernelSize != prevFlattenKernelSize) {
+    if (cvui::button(frame, controlAreaX, currentY + 40, 120, 25, "Update Preview", 0.35)) {
         needsUpdate = true;
-        prevFlattenKernelSize = flattenKernelSize;
     }
     
-    if (cvui::button(frame, controlAreaX, currentY + 40, 120, 25, "Update Preview", 0.35)) {
+    return needsUpdate;
+}
+
+bool UIComponents::renderFFTFilterParameters(cv::Mat& frame, int startY, int controlAreaX,
+                                           int& maskType, double& cutoff, double& upperCutoff,
+                                           double& notchX, double& notchY,
+                                           PreProcessingFunction currentFunction) {
+    int currentY = startY;
+    bool needsUpdate = false;
+
+    cvui::text(frame, controlAreaX, currentY, "Mask Type:", 0.35);
+    currentY += 25;
+
+    const char* maskNames[] = {"Low-Pass", "High-Pass", "Band-Pass", "Notch"};
+    for (int i = 0; i < 4; i++) {
+        int x = controlAreaX + (i % 2) * 140;
+        int y = currentY + (i / 2) * 30;
+        if (cvui::button(frame, x, y, 100, 25, maskNames[i], 0.3)) {
+            maskType = i;
+            needsUpdate = true;
+        }
+        if (maskType == i) {
+            cvui::text(frame, x + 105, y + 8, "<-", 0.25);
+        }
+    }
+    currentY += 70;
+
+    // 频率以奈奎斯特频率为单位；正向频谱已缓存，拖动滑块只重做乘法和逆变换
+    const char* cutoffLabel = maskType == 2 ? "Lower Cutoff (x Nyquist):" :
+                              maskType == 3 ? "Notch Radius (x Nyquist):" : "Cutoff (x Nyquist):";
+    cvui::text(frame, controlAreaX, currentY, cutoffLabel, 0.35);
+    currentY += 20;
+    cvui::trackbar(frame, controlAreaX, currentY, 200, &cutoff, 0.01, 1.0);
+    cvui::text(frame, controlAreaX + 210, currentY + 8, ("Value: " + std::to_string(cutoff).substr(0, 4)).c_str(), 0.3);
+    currentY += 50;
+
+    if (maskType == 2) {
+        cvui::text(frame, controlAreaX, currentY, "Upper Cutoff (x Nyquist):", 0.35);
+        currentY += 20;
+        cvui::trackbar(frame, controlAreaX, currentY, 200, &upperCutoff, 0.01, 1.0);
+        cvui::text(frame, controlAreaX + 210, currentY + 8, ("Value: " + std::to_string(upperCutoff).substr(0, 4)).c_str(), 0.3);
+        currentY += 50;
+    } else if (maskType == 3) {
+        cvui::text(frame, controlAreaX, currentY, "Notch X (x Nyquist):", 0.35);
+        currentY += 20;
+        cvui::trackbar(frame, controlAreaX, currentY, 200, &notchX, -1.0, 1.0);
+        cvui::text(frame, controlAreaX + 210, currentY + 8, ("Value: " + std::to_string(notchX).substr(0, 5)).c_str(), 0.3);
+        currentY += 50;
+
+        cvui::text(frame, controlAreaX, currentY, "Notch Y (x Nyquist):", 0.35);
+        currentY += 20;
+        cvui::trackbar(frame, controlAreaX, currentY, 200, &notchY, -1.0, 1.0);
+        cvui::text(frame, controlAreaX + 210, currentY + 8, ("Value: " + std::to_string(notchY).substr(0, 5)).c_str(), 0.3);
+        currentY += 50;
+    }
+
+    cvui::text(frame, controlAreaX, currentY, "Gaussian masks; 0.16 ~ Gaussian blur with sigma 2", 0.25);
+    if (cvui::button(frame, controlAreaX, currentY + 25, 120, 25, "Update Preview", 0.35)) {
         needsUpdate = true;
     }
-    
+
     return needsUpdate;
 }
 
@@ -249,6 +454,15 @@ PreProcessingFunction UIComponents::renderPreProcessingFunctionSelection(cv::Mat
     if (cvui::button(frame, controlAreaX, currentY, 100, 25, "GS Erode", 0.3)) {
         return PreProcessingFunction::GRAYSCALE_ERODE;
     }
+    currentY += 40;
+
+    // CORRECTION (图像修正)
+    cvui::text(frame, controlAreaX, currentY, "CORRECTION:", 0.35);
+    currentY += 25;
+
+    if (cvui::button(frame, controlAreaX, currentY, 100, 25, "FFT Filter", 0.3)) {
+        return PreProcessingFunction::FFT_FILTER;
+    }
 
     return PreProcessingFunction::NONE;
 }
@@ -257,8 +471,8 @@ int UIComponents::renderPreProcessingParameters(cv::Mat& frame, int controlAreaX
                                               PreProcessingFunction currentFunction,
                                               double& brightness, double& contrast,
                                               int& histogramMethod, double& clipLimit, int& flattenKernelSize,
-                                              double& prevBrightness, double& prevContrast,
-                                              double& prevClipLimit, int& prevFlattenKernelSize) {
+                                              int& fftMaskType, double& fftCutoff, double& fftUpperCutoff,
+                                              double& fftNotchX, double& fftNotchY) {
     int currentY = controlAreaY;
 
     // 显示当前选择的功能名称和返回按钮
@@ -283,15 +497,19 @@ int UIComponents::renderPreProcessingParameters(cv::Mat& frame, int controlAreaX
     switch (currentFunction) {
         case PreProcessingFunction::ADJUST_CONTRAST:
             needsUpdate = renderAdjustContrastParameters(frame, currentY, controlAreaX,
-                                                       brightness, contrast, prevBrightness, prevContrast, currentFunction);
+                                                       brightness, contrast, currentFunction);
             break;
         case PreProcessingFunction::HISTOGRAM_EQUALIZATION:
             needsUpdate = renderHistogramEqualizationParameters(frame, currentY, controlAreaX,
-                                                               histogramMethod, clipLimit, prevClipLimit, currentFunction);
+                                                               histogramMethod, clipLimit, currentFunction);
             break;
         case PreProcessingFunction::FLATTEN_BACKGROUND:
             needsUpdate = renderFlattenBackgroundParameters(frame, currentY, controlAreaX,
-                                                           flattenKernelSize, prevFlattenKernelSize, currentFunction);
+                                                           flattenKernelSize, currentFunction);
+            break;
+        case PreProcessingFunction::FFT_FILTER:
+            needsUpdate = renderFFTFilterParameters(frame, currentY, controlAreaX, fftMaskType, fftCutoff,
+                                                   fftUpperCutoff, fftNotchX, fftNotchY, currentFunction);
             break;
         default:
             cvui::text(frame, controlAreaX, currentY, "No parameters for this function.", 0.35);
@@ -299,7 +517,7 @@ int UIComponents::renderPreProcessingParameters(cv::Mat& frame, int controlAreaX
             break;
     }
 
-    return needsUpdate ? 2 : 0; // 2 = update preview, 0 = no action
+    return needsUpdate ? 2 : 0; // 2 = update preview now, 0 = no action
 }
 
 // Segmentation UI methods implementation
@@ -442,7 +660,7 @@ int UIComponents::renderSegmentationParameters(cv::Mat& frame, int controlAreaX,
         needsUpdate = true;
     }
 
-    return needsUpdate ? 2 : 0; // 2 = update preview, 0 = no action
+    return needsUpdate ? 2 : 0; // 2 = update preview now, 0 = no action
 }
 
 // Morphology UI methods implementation
@@ -575,7 +793,7 @@ int UIComponents::renderMorphologyParameters(cv::Mat& frame, int controlAreaX, i
         needsUpdate = true;
     }
 
-    return needsUpdate ? 2 : 0; // 2 = update preview, 0 = no action
+    return needsUpdate ? 2 : 0; // 2 = update preview now, 0 = no action
 }
 
 // CleanUp UI methods implementation
@@ -691,7 +909,7 @@ int UIComponents::renderCleanUpParameters(cv::Mat& frame, int controlAreaX, int
         needsUpdate = true;
     }
 
-    return needsUpdate ? 2 : 0; // 2 = update preview, 0 = no action
+    return needsUpdate ? 2 : 0; // 2 = update preview now, 0 = no action
 }
 
 // Measurements UI methods implementation
@@ -766,7 +984,7 @@ int UIComponents::renderMeasurementsParameters(cv::Mat& frame, int controlAreaX,
         needsUpdate = true;
     }
 
-    return needsUpdate ? 2 : 0; // 2 = update preview, 0 = no action
+    return needsUpdate ? 2 : 0; // 2 = update preview now, 0 = no action
 }
 
 void UIComponents::renderMeasurementResults(cv::Mat& frame, int x, int y, int width, int height, const MeasurementResult& result) {
@@ -0,0 +1,278 @@
+#include "Pipeline.h"
+#include "Profiler.h"
+#include "TileProcessor.h"
+#include "TiffImageSource.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+struct BatchOptions {
+    std::string pipelinePath;
+    std::string inputPattern;
+    std::string outputDir;
+    int threads = 0;
+    int tileSize = 0;       // 0表示不分块
+    std::string timingsPath;    // 非空时写出各功能的耗时统计
+};
+
+struct FileResult {
+    bool ok = false;
+    std::vector<MeasurementResult> measurements;
+};
+
+void printUsage() {
+    std::cout << "Usage: ImageProcessingBatch <pipeline.yml> <input glob> <output dir> [--threads N] [--tile N] [--timings PATH]" << std::endl;
+    std::cout << "  e.g. ImageProcessingBatch recipe.yml \"shift42/*.tif\" out --threads 8" << std::endl;
+    std::cout << "  --tile N  process each image in N x N tiles (for very large images); with libtiff and a fully tileable" << std::endl;
+    std::cout << "            pipeline the result is streamed into a single tiled TIFF (<name>.tif)" << std::endl;
+    std::cout << "  --timings PATH  write per-function latency statistics as CSV" << std::endl;
+}
+
+// 输出文件名保留输入的扩展名（a.tif -> a.tif.png），不同格式的同名输入不会互相覆盖
+std::string outputName(const std::string& inputPath) {
+    return std::filesystem::path(inputPath).filename().string();
+}
+
+// 能无损保存该位深的扩展名：PNG只能保存8/16位无符号图像，cv::imwrite会把其他位深（如32位窗口和）静默截断到8位
+std::string extensionFor(int depth) {
+    return depth == CV_8U || depth == CV_16U ? "png" : "tif";
+}
+
+// CSV字段加引号，内部的引号写两次
+std::string csvQuote(const std::string& field) {
+    std::string quoted = "\"";
+    for (char c : field) {
+        if (c == '"') {
+            quoted += '"';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+bool parseArguments(int argc, char** argv, BatchOptions& options) {
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (arg == "--tile" && i + 1 < argc) {
+            options.tileSize = std::atoi(argv[++i]);
+        } else if (arg == "--timings" && i + 1 < argc) {
+            options.timingsPath = argv[++i];
+        } else if (arg == "-h" || arg == "--help") {
+            return false;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 3) {
+        return false;
+    }
+    options.pipelinePath = positional[0];
+    options.inputPattern = positional[1];
+    options.outputDir = positional[2];
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BatchOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return -1;
+    }
+
+    try {
+        Pipeline pipeline;
+        if (!pipeline.loadFromFile(options.pipelinePath)) {
+            return -1;
+        }
+
+        std::vector<cv::String> files;
+        cv::glob(options.inputPattern, files, false);
+        if (files.empty()) {
+            std::cerr << "No input files match: " << options.inputPattern << std::endl;
+            return -1;
+        }
+
+        // 不同目录中的同名文件会写到同一个输出文件，处理前拒绝
+        std::map<std::string, std::string> outputOwners;
+        for (const cv::String& file : files) {
+            auto inserted = outputOwners.emplace(outputName(file), file);
+            if (!inserted.second) {
+                std::cerr << "Output name collision: " << inserted.first->second << " and " << file
+                          << " would both be written as " << inserted.first->first << std::endl;
+                return -1;
+            }
+        }
+
+        std::filesystem::create_directories(options.outputDir);
+
+        int threadCount = options.threads > 0 ? options.threads : (int)std::thread::hardware_concurrency();
+        bool tiled = options.tileSize > 0;
+        bool fullyTileable = TileProcessor::isTileable(pipeline.getSteps());
+
+        TileOptions tileOptions;
+        if (tiled) {
+            // 按分块并行：逐个处理文件。全部步骤可分块时结果逐块写入分块TIFF，峰值内存由分块大小 × 线程数决定；
+            // 否则整幅图像驻留内存，只有可分块的步骤分块执行
+            tileOptions.tileSize = options.tileSize;
+            if (fullyTileable && TiffTileSink::isAvailable()) {
+                // TIFF分块的边长必须是16的倍数
+                tileOptions.tileSize = (options.tileSize + 15) / 16 * 16;
+                if (tileOptions.tileSize != options.tileSize) {
+                    std::cout << "Tile size rounded up to " << tileOptions.tileSize << " px for the tiled TIFF output" << std::endl;
+                }
+            } else if (fullyTileable) {
+                std::cout << "Built without libtiff: tiled results are assembled in memory before writing" << std::endl;
+            }
+            tileOptions.threads = threadCount;
+            cv::setNumThreads(threadCount);
+            threadCount = 1;
+            if (!fullyTileable) {
+                std::cout << "Pipeline contains steps that need the whole image; they run untiled" << std::endl;
+            }
+        } else {
+            // 按文件并行：每个线程处理整幅图像，关闭OpenCV内部线程避免超额订阅
+            threadCount = std::max(1, std::min(threadCount, (int)files.size()));
+            cv::setNumThreads(1);
+        }
+
+        std::vector<FileResult> results(files.size());
+        std::atomic<size_t> nextIndex(0);
+        std::atomic<int> failedCount(0);
+        std::mutex outputMutex;
+
+        auto worker = [&]() {
+            while (true) {
+                size_t index = nextIndex.fetch_add(1);
+                if (index >= files.size()) {
+                    break;
+                }
+
+                const std::string inputPath = files[index];
+                try {
+                    // 在原图（金字塔第0层）上处理；界面保存的配方已换算到全分辨率
+                    std::shared_ptr<TileSource> source = TiffImageSource::openFile(inputPath);
+                    if (!source) {
+                        std::lock_guard<std::mutex> lock(outputMutex);
+                        std::cerr << "Failed to load image: " << inputPath << std::endl;
+                        failedCount++;
+                        continue;
+                    }
+
+                    cv::Mat output;
+                    cv::Rect fullImage(cv::Point(), source->size());
+                    if (tiled && fullyTileable && TiffTileSink::isAvailable()) {
+                        // 直接从文件按区域解码、逐块写入一个分块TIFF，输入和结果都不需要整体驻留内存
+                        std::filesystem::path outputPath = std::filesystem::path(options.outputDir) / outputName(inputPath);
+                        outputPath += ".tif";
+                        TiffTileSink sink(outputPath.string(), source->size(), tileOptions.tileSize);
+                        bool processed = TileProcessor::run(*source, sink, pipeline.getSteps(), tileOptions);
+                        if (!sink.close() || !processed) {
+                            std::lock_guard<std::mutex> lock(outputMutex);
+                            std::cerr << "Failed to process tiles of " << inputPath << std::endl;
+                            failedCount++;
+                            continue;
+                        }
+                        results[index].ok = true;
+                        continue;
+                    } else if (tiled && fullyTileable) {
+                        // 没有libtiff时输入仍按区域读取，结果拼接在内存中后整体写出
+                        MatTileSink sink(source->size());
+                        if (TileProcessor::run(*source, sink, pipeline.getSteps(), tileOptions)) {
+                            output = sink.getResult();
+                        }
+                    } else if (tiled) {
+                        output = TileProcessor::run(source->readRegion(fullImage), pipeline.getSteps(), tileOptions,
+                                                    &results[index].measurements);
+                    } else {
+                        output = pipeline.run(source->readRegion(fullImage), &results[index].measurements);
+                    }
+
+                    if (output.empty()) {
+                        std::lock_guard<std::mutex> lock(outputMutex);
+                        std::cerr << "Failed to process " << inputPath << std::endl;
+                        failedCount++;
+                        continue;
+                    }
+
+                    std::filesystem::path outputPath = std::filesystem::path(options.outputDir) / outputName(inputPath);
+                    outputPath += "." + extensionFor(output.depth());
+                    if (!cv::imwrite(outputPath.string(), output)) {
+                        std::lock_guard<std::mutex> lock(outputMutex);
+                        std::cerr << "Failed to write image: " << outputPath.string() << std::endl;
+                        failedCount++;
+                        continue;
+                    }
+                    results[index].ok = true;
+                } catch (const std::exception& e) {
+                    std::lock_guard<std::mutex> lock(outputMutex);
+                    std::cerr << "Error processing " << inputPath << ": " << e.what() << std::endl;
+                    failedCount++;
+                }
+            }
+        };
+
+        if (tiled) {
+            std::cout << "Processing " << files.size() << " images in " << tileOptions.tileSize << " px tiles with "
+                      << tileOptions.threads << " threads" << std::endl;
+        } else {
+            std::cout << "Processing " << files.size() << " images with " << threadCount << " threads" << std::endl;
+        }
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> workers;
+        for (int i = 0; i < threadCount; i++) {
+            workers.emplace_back(worker);
+        }
+        for (std::thread& t : workers) {
+            t.join();
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        size_t processed = files.size() - failedCount;
+        std::cout << "Processed " << processed << "/" << files.size() << " images in " << seconds << " s ("
+                  << (seconds > 0 ? processed / seconds : 0.0) << " images/s)" << std::endl;
+
+        // 流水线包含测量步骤时输出汇总表
+        bool hasMeasurements = false;
+        for (const PipelineStep& step : pipeline.getSteps()) {
+            if (step.module == PipelineModule::MEASUREMENTS) {
+                hasMeasurements = true;
+            }
+        }
+        if (hasMeasurements) {
+            std::filesystem::path csvPath = std::filesystem::path(options.outputDir) / "measurements.csv";
+            std::ofstream csv(csvPath);
+            csv << "file,step,objectCount,totalArea,averageSize\n";
+            for (size_t i = 0; i < files.size(); i++) {
+                for (size_t m = 0; m < results[i].measurements.size(); m++) {
+                    const MeasurementResult& r = results[i].measurements[m];
+                    csv << csvQuote(files[i]) << "," << m << "," << r.objectCount << "," << r.totalArea << "," << r.averageSize << "\n";
+                }
+            }
+            std::cout << "Measurements written to " << csvPath.string() << std::endl;
+        }
+
+        if (!options.timingsPath.empty()) {
+            Profiler::dumpToFile(options.timingsPath);
+        }
+
+        return failedCount > 0 ? 1 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Batch error: " << e.what() << std::endl;
+        return -1;
+    }
+}
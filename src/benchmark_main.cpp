@@ -0,0 +1,359 @@
+#include "Pipeline.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+namespace {
+
+// 大邻域用例的固定参数，与--kernels无关：覆盖直方图中值、积分图和递归高斯等只在大核时启用的实现
+const std::vector<int> kLargeKernels = {31, 101};
+const std::vector<double> kLargeSigmas = {20, 50};
+
+struct BenchmarkOptions {
+    std::vector<double> sizesMP = {1, 4, 16, 100};
+    std::vector<int> kernels = {3, 7, 15};
+    std::string filter;
+    std::string csvPath = "benchmark.csv";
+    double minTime = 0.5;       // 每个用例至少累计的测量时间（秒）
+    double maxSeconds = 30.0;   // 预计单次运行超过该时间的用例跳过
+    int maxRepeats = 10;
+    int threads = 0;            // 0表示使用OpenCV默认线程数
+};
+
+enum class InputKind {
+    GRAY,
+    BGR,
+    BINARY
+};
+
+/**
+ * @brief 一个基准用例：一个功能在一组参数下的调用
+ */
+struct BenchmarkCase {
+    std::string name;           // 模块/功能名
+    PipelineStep step;
+    int kernel;                 // 邻域大小，0表示没有邻域参数
+    InputKind input;
+};
+
+struct SyntheticImages {
+    cv::Mat gray;
+    cv::Mat bgr;
+    cv::Mat binary;
+};
+
+const char* inputName(InputKind input) {
+    switch (input) {
+        case InputKind::GRAY: return "gray";
+        case InputKind::BGR: return "bgr";
+        default: return "binary";
+    }
+}
+
+std::vector<double> parseList(const std::string& text) {
+    std::vector<double> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            values.push_back(std::atof(item.c_str()));
+        }
+    }
+    return values;
+}
+
+void printUsage() {
+    std::cout << "Usage: ImageProcessingBenchmark [options]" << std::endl;
+    std::cout << "  --sizes 1,4,16,100   image sizes in megapixels" << std::endl;
+    std::cout << "  --kernels 3,7,15     kernel sizes for functions with a neighborhood" << std::endl;
+    std::cout << "  --filter TEXT        only run cases whose name contains TEXT (e.g. Morphology/)" << std::endl;
+    std::cout << "  --csv PATH           machine-readable results (default benchmark.csv)" << std::endl;
+    std::cout << "  --min-time S         minimum measured time per case in seconds (default 0.5)" << std::endl;
+    std::cout << "  --max-seconds S      skip cases expected to take longer per run (default 30)" << std::endl;
+    std::cout << "  --threads N          OpenCV worker threads" << std::endl;
+}
+
+bool parseArguments(int argc, char** argv, BenchmarkOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--sizes" && hasValue) {
+            options.sizesMP = parseList(argv[++i]);
+        } else if (arg == "--kernels" && hasValue) {
+            options.kernels.clear();
+            for (double k : parseList(argv[++i])) {
+                options.kernels.push_back((int)k | 1);
+            }
+        } else if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        } else if (arg == "--csv" && hasValue) {
+            options.csvPath = argv[++i];
+        } else if (arg == "--min-time" && hasValue) {
+            options.minTime = std::atof(argv[++i]);
+        } else if (arg == "--max-seconds" && hasValue) {
+            options.maxSeconds = std::atof(argv[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = std::atoi(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+    return !options.sizesMP.empty() && !options.kernels.empty();
+}
+
+/**
+ * @brief 生成确定性的合成图像：平滑背景 + 随机亮/暗斑点 + 噪声
+ * 斑点数量与面积成正比，使分割、清理和测量在各尺寸下的负载密度一致
+ */
+SyntheticImages makeImages(double megapixels) {
+    double pixels = megapixels * 1e6;
+    int width = (int)std::lround(std::sqrt(pixels * 4.0 / 3.0));
+    int height = (int)std::lround(pixels / width);
+
+    SyntheticImages images;
+    cv::RNG rng(12345);
+
+    cv::Mat row(1, width, CV_8U);
+    for (int x = 0; x < width; x++) {
+        row.at<uchar>(0, x) = (uchar)(60 + 60 * x / std::max(1, width - 1));
+    }
+    cv::repeat(row, height, 1, images.gray);
+
+    int blobCount = std::max(1, (int)(pixels / 2000));
+    for (int i = 0; i < blobCount; i++) {
+        cv::Point center(rng.uniform(0, width), rng.uniform(0, height));
+        int radius = rng.uniform(3, 20);
+        int intensity = rng.uniform(0, 2) ? rng.uniform(170, 255) : rng.uniform(0, 40);
+        cv::circle(images.gray, center, radius, cv::Scalar(intensity), cv::FILLED);
+    }
+
+    cv::Mat noise(images.gray.size(), CV_16S);
+    rng.fill(noise, cv::RNG::NORMAL, 0, 8);
+    cv::add(images.gray, noise, images.gray, cv::noArray(), CV_8U);
+
+    cv::Mat tint(images.gray.size(), CV_8UC3);
+    rng.fill(tint, cv::RNG::UNIFORM, 0, 30);
+    cv::cvtColor(images.gray, images.bgr, cv::COLOR_GRAY2BGR);
+    cv::add(images.bgr, tint, images.bgr);
+
+    cv::threshold(images.gray, images.binary, 150, 255, cv::THRESH_BINARY);
+    return images;
+}
+
+void addKernelCases(std::vector<BenchmarkCase>& cases, const std::string& name, PipelineModule module, int function,
+                    const std::vector<int>& kernels, const std::vector<double>& extraParams, size_t kernelIndex,
+                    const std::vector<InputKind>& inputs) {
+    for (int kernel : kernels) {
+        std::vector<double> params = extraParams;
+        params.insert(params.begin() + kernelIndex, kernel);
+        for (InputKind input : inputs) {
+            cases.push_back({name, PipelineStep(module, function, params), kernel, input});
+        }
+    }
+}
+
+void addCase(std::vector<BenchmarkCase>& cases, const std::string& name, PipelineModule module, int function,
+             const std::vector<double>& params, int kernel, const std::vector<InputKind>& inputs) {
+    for (InputKind input : inputs) {
+        cases.push_back({name, PipelineStep(module, function, params), kernel, input});
+    }
+}
+
+/**
+ * @brief 所有模块的全部功能；参数取界面中的常用值
+ */
+std::vector<BenchmarkCase> buildCases(const std::vector<int>& kernels) {
+    const std::vector<InputKind> grayAndBgr = {InputKind::GRAY, InputKind::BGR};
+    const std::vector<InputKind> bgrOnly = {InputKind::BGR};
+    const std::vector<InputKind> binaryOnly = {InputKind::BINARY};
+    std::vector<BenchmarkCase> cases;
+
+    const PipelineModule pre = PipelineModule::PRE_PROCESSING;
+    addCase(cases, "PreProcessing/AdjustContrast", pre, (int)PreProcessingFunction::ADJUST_CONTRAST, {20, 1.2}, 0, grayAndBgr);
+    addCase(cases, "PreProcessing/HistogramEqualization", pre, (int)PreProcessingFunction::HISTOGRAM_EQUALIZATION, {0, 2.0}, 0, grayAndBgr);
+    addCase(cases, "PreProcessing/CLAHE", pre, (int)PreProcessingFunction::HISTOGRAM_EQUALIZATION, {1, 2.0}, 0, grayAndBgr);
+    addKernelCases(cases, "PreProcessing/FlattenBackground", pre, (int)PreProcessingFunction::FLATTEN_BACKGROUND, kernels, {}, 0, grayAndBgr);
+    addKernelCases(cases, "PreProcessing/Median", pre, (int)PreProcessingFunction::MEDIAN_FILTER, kernels, {}, 0, grayAndBgr);
+    addKernelCases(cases, "PreProcessing/Wiener", pre, (int)PreProcessingFunction::WIENER_FILTER, kernels, {}, 0, grayAndBgr);
+    addCase(cases, "PreProcessing/NonLocalMeans", pre, (int)PreProcessingFunction::NON_LOCAL_MEANS, {10, 7, 21}, 21, grayAndBgr);
+    addKernelCases(cases, "PreProcessing/Gaussian", pre, (int)PreProcessingFunction::GAUSSIAN_BLUR, kernels, {0, 0}, 0, grayAndBgr);
+    for (double sigma : kLargeSigmas) {
+        addCase(cases, "PreProcessing/GaussianSigma" + std::to_string((int)sigma), pre, (int)PreProcessingFunction::GAUSSIAN_BLUR,
+                {0, sigma, sigma}, 0, grayAndBgr);
+    }
+    addKernelCases(cases, "PreProcessing/Average", pre, (int)PreProcessingFunction::AVERAGE_BLUR, kernels, {}, 0, grayAndBgr);
+    addKernelCases(cases, "PreProcessing/Sum", pre, (int)PreProcessingFunction::SUM_FILTER, kernels, {0, 1.0}, 0, grayAndBgr);
+    addKernelCases(cases, "PreProcessing/MedianLarge", pre, (int)PreProcessingFunction::MEDIAN_FILTER, kLargeKernels, {}, 0, grayAndBgr);
+    addKernelCases(cases, "PreProcessing/SumLarge", pre, (int)PreProcessingFunction::SUM_FILTER, kLargeKernels, {0, 1.0}, 0, grayAndBgr);
+    addKernelCases(cases, "PreProcessing/StdDevLarge", pre, (int)PreProcessingFunction::STDDEV_FILTER, kLargeKernels, {}, 0, grayAndBgr);
+    addKernelCases(cases, "PreProcessing/GrayscaleDilate", pre, (int)PreProcessingFunction::GRAYSCALE_DILATE, kernels, {}, 0, grayAndBgr);
+    addKernelCases(cases, "PreProcessing/GrayscaleErode", pre, (int)PreProcessingFunction::GRAYSCALE_ERODE, kernels, {}, 0, grayAndBgr);
+    addKernelCases(cases, "PreProcessing/StdDev", pre, (int)PreProcessingFunction::STDDEV_FILTER, kernels, {}, 0, grayAndBgr);
+    addKernelCases(cases, "PreProcessing/Entropy", pre, (int)PreProcessingFunction::ENTROPY_FILTER, kernels, {}, 0, grayAndBgr);
+    addCase(cases, "PreProcessing/Gradient", pre, (int)PreProcessingFunction::GRADIENT_FILTER, {}, 3, grayAndBgr);
+    addCase(cases, "PreProcessing/HighlightLines", pre, (int)PreProcessingFunction::HIGHLIGHT_LINES, {}, 3, grayAndBgr);
+    addKernelCases(cases, "PreProcessing/BrightTexture", pre, (int)PreProcessingFunction::BRIGHT_TEXTURE, kernels, {}, 0, grayAndBgr);
+    addKernelCases(cases, "PreProcessing/DarkTexture", pre, (int)PreProcessingFunction::DARK_TEXTURE, kernels, {}, 0, grayAndBgr);
+    addCase(cases, "PreProcessing/AdvancedTexture", pre, (int)PreProcessingFunction::ADVANCED_TEXTURE, {5}, 5, grayAndBgr);
+    addKernelCases(cases, "PreProcessing/Similarity", pre, (int)PreProcessingFunction::SIMILARITY, kernels, {}, 0, grayAndBgr);
+    addCase(cases, "PreProcessing/Sharpen", pre, (int)PreProcessingFunction::SHARPEN, {1.0}, 3, grayAndBgr);
+    addCase(cases, "PreProcessing/FFT", pre, (int)PreProcessingFunction::FFT_FILTER, {}, 0, grayAndBgr);
+    addCase(cases, "PreProcessing/GrayscaleInterpolation", pre, (int)PreProcessingFunction::GRAYSCALE_INTERPOLATION, {}, 0, grayAndBgr);
+    addCase(cases, "PreProcessing/GrayscaleReconstruction", pre, (int)PreProcessingFunction::GRAYSCALE_RECONSTRUCTION, {}, 5, grayAndBgr);
+
+    const PipelineModule seg = PipelineModule::SEGMENTATION;
+    addCase(cases, "Segmentation/Basic", seg, (int)SegmentationFunction::BASIC_THRESHOLD, {127, 0}, 0, grayAndBgr);
+    addCase(cases, "Segmentation/Range", seg, (int)SegmentationFunction::RANGE_THRESHOLD, {50, 200}, 0, grayAndBgr);
+    addKernelCases(cases, "Segmentation/Adaptive", seg, (int)SegmentationFunction::ADAPTIVE_THRESHOLD, kernels, {0, 0, 2}, 2, grayAndBgr);
+    addCase(cases, "Segmentation/EM", seg, (int)SegmentationFunction::EM_THRESHOLD, {}, 0, grayAndBgr);
+    addKernelCases(cases, "Segmentation/Local", seg, (int)SegmentationFunction::LOCAL_THRESHOLD, kernels, {2}, 0, grayAndBgr);
+
+    const PipelineModule morph = PipelineModule::MORPHOLOGY;
+    addKernelCases(cases, "Morphology/Dilate", morph, (int)MorphologyFunction::DILATE, kernels, {1}, 0, grayAndBgr);
+    addKernelCases(cases, "Morphology/Erode", morph, (int)MorphologyFunction::ERODE, kernels, {1}, 0, grayAndBgr);
+    addKernelCases(cases, "Morphology/Opening", morph, (int)MorphologyFunction::OPENING, kernels, {1}, 0, grayAndBgr);
+    addKernelCases(cases, "Morphology/Closing", morph, (int)MorphologyFunction::CLOSING, kernels, {1}, 0, grayAndBgr);
+    addKernelCases(cases, "Morphology/Gradient", morph, (int)MorphologyFunction::GRADIENT, kernels, {1}, 0, grayAndBgr);
+    addKernelCases(cases, "Morphology/TopHat", morph, (int)MorphologyFunction::TOP_HAT, kernels, {1}, 0, grayAndBgr);
+    addKernelCases(cases, "Morphology/BlackHat", morph, (int)MorphologyFunction::BLACK_HAT, kernels, {1}, 0, grayAndBgr);
+    addCase(cases, "Morphology/SeparateFeatures", morph, (int)MorphologyFunction::SEPARATE_FEATURES, {5, 1, 100, 0}, 5, grayAndBgr);
+
+    const PipelineModule clean = PipelineModule::CLEAN_UP;
+    addCase(cases, "CleanUp/FillAllHoles", clean, (int)CleanUpFunction::FILL_ALL_HOLES, {50, 0}, 0, binaryOnly);
+    addCase(cases, "CleanUp/RejectFeatures", clean, (int)CleanUpFunction::REJECT_FEATURES, {10, 1000, 0}, 0, binaryOnly);
+
+    addCase(cases, "Measurements/Count", PipelineModule::MEASUREMENTS, (int)MeasurementsFunction::COUNT, {10, 10000, 0.5}, 0, binaryOnly);
+
+    const PipelineModule color = PipelineModule::COLOR;
+    addCase(cases, "Color/ConvertGrayscale", color, (int)ColorFunction::CONVERT_GRAYSCALE, {}, 0, bgrOnly);
+    addCase(cases, "Color/ColorSelect", color, (int)ColorFunction::COLOR_SELECT, {0, 179, 0, 255, 0, 255}, 0, bgrOnly);
+    addCase(cases, "Color/Cluster", color, (int)ColorFunction::COLOR_CLUSTER, {3}, 0, bgrOnly);
+    addCase(cases, "Color/Deconvolution", color, (int)ColorFunction::COLOR_DECONVOLUTION, {0}, 0, bgrOnly);
+    addCase(cases, "Color/ChannelOperation", color, (int)ColorFunction::CHANNEL_OPERATION, {2, 1.5}, 0, bgrOnly);
+
+    return cases;
+}
+
+/**
+ * @brief 调用一次功能；测量只计算applyFunction本身，不包括界面使用的标注图
+ */
+void runOnce(const BenchmarkCase& benchmarkCase, const cv::Mat& input) {
+    if (benchmarkCase.step.module == PipelineModule::MEASUREMENTS) {
+        Measurements::applyFunction(input, (MeasurementsFunction)benchmarkCase.step.function, benchmarkCase.step.params);
+    } else {
+        Pipeline::applyStep(input, benchmarkCase.step);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return -1;
+    }
+    if (options.threads > 0) {
+        cv::setNumThreads(options.threads);
+    }
+
+    std::vector<BenchmarkCase> cases;
+    for (const BenchmarkCase& c : buildCases(options.kernels)) {
+        if (options.filter.empty() || c.name.find(options.filter) != std::string::npos) {
+            cases.push_back(c);
+        }
+    }
+    std::sort(options.sizesMP.begin(), options.sizesMP.end());
+
+    std::ofstream csv(options.csvPath);
+    if (!csv) {
+        std::cerr << "Failed to open " << options.csvPath << std::endl;
+        return -1;
+    }
+    csv << "name,input,kernel,megapixels,width,height,runs,median_ms,ns_per_pixel,mpix_per_s,status\n";
+
+    std::cout << "OpenCV " << CV_VERSION << ", " << cv::getNumThreads() << " threads, " << cases.size() << " cases" << std::endl;
+    std::cout << std::left << std::setw(40) << "name" << std::setw(8) << "input" << std::setw(7) << "kernel"
+              << std::setw(8) << "MP" << std::right << std::setw(12) << "ms" << std::setw(12) << "ns/px"
+              << std::setw(10) << "MP/s" << std::endl;
+
+    // 上一尺寸测得的ns/px，用来估计并跳过过慢的大图用例
+    std::map<std::string, double> lastNsPerPixel;
+
+    for (double megapixels : options.sizesMP) {
+        SyntheticImages images = makeImages(megapixels);
+        double pixels = (double)images.gray.total();
+
+        for (const BenchmarkCase& c : cases) {
+            const cv::Mat& input = c.input == InputKind::GRAY ? images.gray
+                                 : c.input == InputKind::BGR ? images.bgr : images.binary;
+            std::string key = c.name + "|" + inputName(c.input) + "|" + std::to_string(c.kernel) + "|" +
+                              Pipeline::describeStep(c.step);
+
+            std::string status = "ok";
+            std::vector<double> samples;
+            auto previous = lastNsPerPixel.find(key);
+            if (previous != lastNsPerPixel.end() && previous->second * pixels * 1e-9 > options.maxSeconds) {
+                status = "skipped";
+            } else {
+                try {
+                    // 第一次运行作为预热；已经超过最短测量时间时直接记录
+                    double total = 0;
+                    bool warmup = true;
+                    while ((int)samples.size() < options.maxRepeats) {
+                        auto start = std::chrono::steady_clock::now();
+                        runOnce(c, input);
+                        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                        if (warmup && seconds < options.minTime) {
+                            warmup = false;
+                            continue;
+                        }
+                        warmup = false;
+                        samples.push_back(seconds);
+                        total += seconds;
+                        if (total >= options.minTime) {
+                            break;
+                        }
+                    }
+                } catch (const cv::Exception& e) {
+                    status = "error";
+                    std::cerr << c.name << " failed: " << e.what() << std::endl;
+                }
+            }
+
+            double medianMs = 0, nsPerPixel = 0, mpixPerSecond = 0;
+            if (!samples.empty()) {
+                std::sort(samples.begin(), samples.end());
+                double median = samples[samples.size() / 2];
+                medianMs = median * 1e3;
+                nsPerPixel = median * 1e9 / pixels;
+                mpixPerSecond = pixels / median / 1e6;
+                lastNsPerPixel[key] = nsPerPixel;
+            }
+
+            csv << c.name << "," << inputName(c.input) << "," << c.kernel << "," << megapixels << ","
+                << input.cols << "," << input.rows << "," << samples.size() << "," << medianMs << ","
+                << nsPerPixel << "," << mpixPerSecond << "," << status << "\n";
+            csv.flush();
+
+            std::cout << std::left << std::setw(40) << c.name << std::setw(8) << inputName(c.input)
+                      << std::setw(7) << c.kernel << std::setw(8) << megapixels << std::right << std::fixed
+                      << std::setprecision(2);
+            if (status == "ok") {
+                std::cout << std::setw(12) << medianMs << std::setw(12) << nsPerPixel << std::setw(10) << mpixPerSecond;
+            } else {
+                std::cout << std::setw(12) << status;
+            }
+            std::cout << std::defaultfloat << std::setprecision(6) << std::endl;
+        }
+    }
+
+    std::cout << "Results written to " << options.csvPath << std::endl;
+    return 0;
+}